@@ -6,166 +6,358 @@
 #include "mtp_struct.h"
 #include "logger.h"
 
-int isValidDirectory(const char *path) 
+int isValidDirectory(const char *path)
 {
-    struct stat sb;
+    /*
+        Check if the path exists and is a directory with a single open syscall;
+        O_DIRECTORY has the kernel report ENOTDIR atomically, with no stat
+        buffer to fill and copy out.
+    */
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
 
-    // Check if the path exists and is a directory
-    if(stat(path, &sb) == 0) 
+    if(fd >= 0)
     {
-        if(S_ISDIR(sb.st_mode)) 
-        {
-            return 1;  // It's a valid directory
-        } 
-        
-        else 
-        {
-            fprintf(stderr, "Error: '%s' exists but is not a directory.\n", path);
-        }
-    } 
-    
-    else 
+        close(fd);
+        return 1;  // It's a valid directory
+    }
+
+    /*
+        These messages are rare and effectively fatal, so write them straight
+        to the stderr descriptor; dprintf skips the stdio stream machinery
+        (locking, buffering) that fprintf(stderr, ...) would pull in.
+    */
+    if(errno == ENOTDIR)
+    {
+        dprintf(STDERR_FILENO, "Error: '%s' exists but is not a directory.\n", path);
+    }
+
+    else
     {
-        fprintf(stderr, "Error: Cannot access '%s': %s\n", path, strerror(errno));
+        dprintf(STDERR_FILENO, "Error: Cannot access '%s': %s\n", path, strerror(errno));
     }
-    
+
     return 0;  // It's not a valid directory
 }
 
-char* getFilePath(const char* directory, const char* name, const char* extension) 
+int getFilePath(char* out, size_t cap, const char* directory, const char* name, const char* extension)
 {
-    // Allocate memory for the full path
-    char* filePath = malloc(MAX_FILE_PATH_LENGTH);
+    // Create the full path in the format: <directory>/<name>.<extension>
+    // The caller owns the buffer, so no heap allocation (or free) is needed.
+    return snprintf(out, cap, "%s/%s.%s", directory, name, extension);
+}
+
+/*
+    Per-type value parsers for the generated key table. Every parsed field is
+    a single byte (bool or uint8_t), so each parser returns the raw byte the
+    dispatcher stores through the field's offset, or -1 when the value does
+    not parse and the line should be skipped.
+*/
 
-    if (filePath == NULL) 
+// The value is "True" or "False", so the first byte alone discriminates.
+static int PARSE_bool(const char *value)
+{
+    return (value[0] == 'T');
+}
+
+// Numeric values are parsed in full and range-checked against the field width.
+static int PARSE_uint8_t(const char *value)
+{
+    char *end;
+    unsigned long parsed = strtoul(value, &end, 10);
+
+    if(end == value || parsed > UINT8_MAX)
     {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(EXIT_FAILURE);
+        dprintf(STDERR_FILENO, "Invalid numeric configuration value '%s', line skipped.\n", value);
+        return -1;
     }
 
-    // Create the full path in the format: <directory>/<name>.<extension>
-    snprintf(filePath, MAX_FILE_PATH_LENGTH, "%s/%s.%s", directory, name, extension);
+    return (int)parsed;
+}
 
-    return filePath;
+/*
+    Dispatch table generated from the CONFIG_FIELDS X-macro in config.h, one
+    entry per key with the Config field offset it stores into. Keys are matched
+    on their length first, so a line costs a single memcmp instead of one
+    strcmp per known key. The table is small enough that a flat scan wins;
+    switch to a binary search over sorted keys if it ever grows past eight.
+*/
+typedef struct {
+    const char *key;
+    uint8_t len;
+    uint8_t offset;
+    int (*parse)(const char*);
+} cfg_entry;
+
+#define GEN_ENTRY(field, type, key) { key, sizeof(key) - 1, offsetof(Config, field), PARSE_##type },
+static const cfg_entry configKeys[] = { CONFIG_FIELDS(GEN_ENTRY) };
+#undef GEN_ENTRY
+#define NUM_CONFIG_KEYS (sizeof(configKeys) / sizeof(configKeys[0]))
+
+/*
+    Parse a single NUL-terminated configuration line. A configuration line
+    is in the format:
+
+    key:value
+
+    where the key and value is deliminated by a colon (:).
+*/
+static void applyConfigurationLine(Config *config, char *line)
+{
+    // Grab the configuration key with a single forward scan for the colon delimiter.
+    char *colon = strchr(line, ':');
+    if(colon == NULL) return;
+
+    size_t keyLen = (size_t)(colon - line);
+    char *value = colon + 1;
+
+    // Dispatch to the handler for this key, if it is a known key.
+    for(size_t i = 0; i < NUM_CONFIG_KEYS; i++)
+    {
+        if(configKeys[i].len == keyLen && memcmp(line, configKeys[i].key, keyLen) == 0)
+        {
+            // Store the parsed byte directly through the field's offset,
+            // leaving the field untouched when the value fails to parse.
+            int parsed = configKeys[i].parse(value);
+            if(parsed >= 0)
+            {
+                *(uint8_t*)((char*)config + configKeys[i].offset) = (uint8_t)parsed;
+            }
+            break;
+        }
+    }
+}
+
+// Fields derived from parsed keys, computed once the whole file is read.
+static void deriveConfigFields(Config *config)
+{
+    // Any tier that is not 1 (0 is the compute tier) is not a leaf
+    config->isLeaf = (config->tier == 1);
 }
 
-void readConfigurationFile(Config *config, const char* configFile) 
+// Fingerprint of the last successfully parsed configuration file. A reload
+// whose mtime and size both match is a no-op and skips the parse entirely.
+static struct {
+    time_t mtime;
+    off_t size;
+    bool valid;
+} prevLoad;
+
+void readConfigurationFile(Config *config, const char* configFile)
 {
     // Access the configuration file.
-    FILE *fp = fopen(configFile, "r");
-    if(!fp) 
+    int fd = open(configFile, O_RDONLY);
+    if(fd < 0)
     {
         perror("\nFailed to open config file\n");
         return;
     }
 
-    /* 
-        Read through each line of the configuration file.
-        A configuration line is in the format:
-
-        key:value
-
-        where the key and value is deliminated by a colon (:).
+    /*
+        Slurp the entire file with a single read and walk the lines in memory,
+        rather than paying a libc call (and its locking) per line. Config files
+        are tiny, so the whole file comfortably fits in one buffer; this also
+        removes the old 255-byte line cap that silently truncated long values.
     */
-    char buff[255];
-    while(fgets(buff, sizeof(buff), fp)) 
+    struct stat sb;
+    if(fstat(fd, &sb) == 0 && sb.st_size > 0)
     {
-        // Grab the configuration key by splitting on the colon delimiter.
-        char *configName = strtok(buff, ":");
-        if(configName == NULL) continue;
-        
-        // Grab the configuration value and remove the newline.
-        char *value = strtok(NULL, "\n"); 
-        if(value == NULL) continue;
-        
-        // Determine if the MTP node is a spine and at the top tier. 
-        if(strcmp(configName, "isTopSpine") == 0) 
+        // Unchanged since the last load, nothing to re-parse.
+        if(prevLoad.valid && prevLoad.mtime == sb.st_mtime && prevLoad.size == sb.st_size)
         {
-            config->isTopSpine = strcmp("True", value) == 0 ? true : false;
-        } 
+            close(fd);
+            return;
+        }
 
-       // Determine the tier of the MTP node. 
-        else if(strcmp(configName, "tier") == 0) 
+        char *data = malloc(sb.st_size + 1);
+        if(data == NULL)
         {
-            // To-Do: Add error check for atoi conversion.
-            uint8_t tierValue = atoi(value);
+            fprintf(stderr, "Memory allocation failed\n");
+            close(fd);
+            exit(EXIT_FAILURE);
+        }
+
+        // Read the full file, tolerating short reads.
+        ssize_t total = 0;
+        while(total < sb.st_size)
+        {
+            ssize_t n = read(fd, data + total, sb.st_size - total);
+            if(n <= 0) break;
+            total += n;
+        }
+        data[total] = '\0';
+        close(fd);
+
+        // Walk each line by finding the next newline and terminating in place.
+        char *line = data;
+        char *end = data + total;
+        while(line < end)
+        {
+            char *newline = memchr(line, '\n', end - line);
+            if(newline != NULL)
+            {
+                *newline = '\0';
+            }
+
+            applyConfigurationLine(config, line);
+
+            line = (newline != NULL) ? newline + 1 : end;
+        }
+
+        free(data);
+        deriveConfigFields(config);
+
+        // Remember what was parsed so an unchanged reload can short-circuit.
+        prevLoad.mtime = sb.st_mtime;
+        prevLoad.size = sb.st_size;
+        prevLoad.valid = true;
+        return;
+    }
+    close(fd);
 
-            config->tier = tierValue;
+    // Fallback: if the file cannot be stat'ed, read it line-by-line instead.
+    FILE *fp = fopen(configFile, "r");
+    if(!fp)
+    {
+        perror("\nFailed to open config file\n");
+        return;
+    }
+
+    // Let stdio refill in large block-aligned chunks rather than the default BUFSIZ.
+    setvbuf(fp, NULL, _IOFBF, 65536);
+
+    char buff[4096] __attribute__((aligned(64)));
+    while(fgets(buff, sizeof(buff), fp))
+    {
+        // Remove the newline before handing the line off.
+        char *newline = strchr(buff, '\n');
+        if(newline != NULL)
+        {
+            *newline = '\0';
+        }
 
-            // Any tier that is not 1 (0 is the compute tier) is not a leaf
-            config->isLeaf = tierValue == 1 ? true : false;
-        } 
+        applyConfigurationLine(config, buff);
     }
 
     fclose(fp);
+    deriveConfigFields(config);
 }
 
-compute_interface* setComputeInterfaces(struct ifaddrs *ifaddr, char *computeSubnetIntfName, bool isLeaf, const char* nodeName)
+// Arena backing the compute and control port nodes. The ports live for the life
+// of the process, so they share one block and come out contiguous in walk order.
+static arena_t portArena;
+
+/*
+    Classify the node's interfaces into the compute and control tables.
+
+    The caller acquires the ifaddrs list with a single getifaddrs() call and
+    both tables are filled from that one list in one walk; getifaddrs itself is
+    expensive on hosts with many addresses, so start-up must never enumerate
+    the interfaces a second time.
+*/
+void classifyInterfaces(struct ifaddrs *ifaddr, char *computeSubnetIntfName, bool isLeaf, const char* nodeName,
+                        compute_interface **compute_intf_head, struct control_port **cp_head)
 {
     struct ifaddrs *ifa;
     int family;
 
-    // Define the head of the Non-MTP-speaking interfaces linked list (AKA the IPv4 compute ports).
-    compute_interface *compute_intf_head = NULL;
+    // Start-up classification happens exactly once per process.
+    static bool interfacesClassified = false;
+    assert(!interfacesClassified);
+    interfacesClassified = true;
+
+    arena_init(&portArena, ARENA_BLOCK_SIZE);
+
+    // Hoist the node name length out of the walk, it is fixed for the life of the process.
+    const size_t nodeNameLen = strlen(nodeName);
+
+    // Define the heads of the compute (IPv4) and control (MTP) interface linked lists.
+    *compute_intf_head = NULL;
+    *cp_head = NULL;
 
     // The node is not a leaf, thus it is a spine and does not have a compute interface.
     if(!isLeaf)
     {
-        strcpy(computeSubnetIntfName, "None");
+        memcpy(computeSubnetIntfName, "None", sizeof("None"));
         log_message("\nNode is a spine, no compute interface.\n");
-        return NULL;
     }
 
-    // Iterate over the network interfaces.
-    for(ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next) 
+    /*
+        Iterate over the network interfaces once, dispatching each entry to the
+        compute or control table based on its address family. The old split
+        setters walked the full list twice for the same classification work.
+    */
+    for(ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next)
     {
+        /*
+            The list is pointer-chased and each node's name and flags sit on
+            their own cachelines; start pulling the next node in while the
+            current one is classified.
+        */
+        if(ifa->ifa_next != NULL) __builtin_prefetch(ifa->ifa_next, 0, 0);
+
         if(ifa->ifa_addr == NULL) continue;
 
-        // AF_INET = IPv4 addressing.
         family = ifa->ifa_addr->sa_family;
 
-        // If the interface is active/up, contains an IPv4 address, and contains the name of the node in the interface.
-        if(family == AF_INET && 
-            strncmp(ifa->ifa_name, nodeName, strlen(nodeName)) == 0 && 
-            (ifa->ifa_flags & IFF_UP) != 0)
+        /*
+            Dispatch on the address family before any string work so that the
+            (many) non-matching families, such as AF_INET6, take a predictable
+            early out without ever touching the interface name.
+        */
+        switch(family)
         {
-            // Mark the interface name as part of the compute interface table, and then copy the interface name seperately.
-            compute_intf_head = addComputeInteface(compute_intf_head, ifa->ifa_name);
-
-            strcpy(computeSubnetIntfName, ifa->ifa_name);
-            log_message("\nInterface %s is set as the compute port.\n", ifa->ifa_name);
-        }
-    }
-    
-    // return the head of the linked list.
-    return compute_intf_head;
-}
+            case AF_INET:
+                /*
+                    If the interface is active/up, contains an IPv4 address, and contains the name of the node in
+                    the interface. The first-byte probe rejects non-matching names before the fixed-width memcmp,
+                    which (unlike strncmp) has no per-byte NUL check for the compiler to worry about.
+                */
+                if(isLeaf &&
+                    ifa->ifa_name[0] == nodeName[0] &&
+                    memcmp(ifa->ifa_name, nodeName, nodeNameLen) == 0 &&
+                    (ifa->ifa_flags & IFF_UP) != 0)
+                {
+                    // Mark the interface name as part of the compute interface table, and then copy the interface name seperately.
+                    *compute_intf_head = addComputeInteface(&portArena, *compute_intf_head, ifa->ifa_name);
 
-struct control_port* setControlInterfaces(struct ifaddrs *ifaddr, char *computeSubnetIntfName, bool isLeaf, const char* nodeName) 
-{
-    // Use ifaddrs structure to loop through network interfaces on the system.
-    struct ifaddrs *ifa;
-    int family;
+                    /*
+                        Only the first match becomes "the" compute port; later matches stay in
+                        the table but skip the redundant name copy. Interface names are bounded
+                        by IFNAMSIZ (16), so a fixed-width copy (a single 16-byte move) replaces
+                        strcpy's byte-at-a-time NUL hunt and makes the bound explicit.
+                    */
+                    if(computeSubnetIntfName[0] == '\0')
+                    {
+                        memcpy(computeSubnetIntfName, ifa->ifa_name, IFNAMSIZ);
+                        computeSubnetIntfName[IFNAMSIZ - 1] = '\0';
+                        LOG_DEBUG("\nInterface %s is set as the compute port.\n", ifa->ifa_name);
+                    }
+                }
+                break;
 
-    // Define the head of the MTP-speaking interfaces linked list (AKA the control ports).
-    struct control_port* cp_head = NULL;
+            // Any link-layer interface that is up is a control port (the compute port is pulled back out below).
+            case AF_PACKET:
+                if(ifa->ifa_flags & IFF_UP)
+                {
+                    *cp_head = add_to_control_port_table(&portArena, *cp_head, ifa->ifa_name);
+                    LOG_DEBUG("Added interface %s as a control port.\n",
+                              ifa->ifa_name);
+                }
+                break;
 
-    // Loop through each network interface on the system.
-    for (ifa = ifaddr; ifa; ifa = ifa->ifa_next)
-    {
-        if (!ifa->ifa_addr) continue;
-
-        if (ifa->ifa_addr->sa_family == AF_PACKET &&
-            (ifa->ifa_flags & IFF_UP) &&                    /* interface is up   */
-            !(isLeaf && strcmp(ifa->ifa_name,               /* skip compute intf */
-                            computeSubnetIntfName) == 0))
-        {
-            cp_head = add_to_control_port_table(cp_head, ifa->ifa_name);
-            log_message("Added interface %s as a control port.\n",
-                        ifa->ifa_name);
+            default:
+                break;
         }
     }
 
-    // return the head of the linked list.
-    return cp_head;
+    /*
+        getifaddrs lists the AF_PACKET entry of an interface before its AF_INET
+        entry, so which interface is the compute port is only known once the
+        walk has finished. Remove it from the control port table here.
+    */
+    if(isLeaf && *cp_head != NULL && computeSubnetIntfName[0] != '\0')
+    {
+        *cp_head = remove_control_port_by_name(*cp_head, computeSubnetIntfName);
+        LOG_DEBUG("Interface %s removed from the control ports, it is the compute port.\n", computeSubnetIntfName);
+    }
 }
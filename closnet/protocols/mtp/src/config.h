@@ -6,6 +6,7 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
@@ -15,7 +16,10 @@
 #include <netdb.h>
 #include <stdbool.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <errno.h>
+#include <assert.h>
 
 /*
  * Custom MTP imports.
@@ -41,14 +45,27 @@ typedef struct Config {
     bool isLeaf;
     bool isTopSpine;
     uint8_t tier;
+    uint8_t logLevel; // log_level_t value; debug unless the config says otherwise.
     char computeIntfName[ETH_LEN];
 } Config;
 
+/*
+    X-macro listing every configuration key alongside the Config field it
+    populates and how the value is parsed. Adding a key is one line here;
+    the dispatch table in config.c is generated from this list, so the
+    parser itself never has to change. Derived fields (isLeaf) are computed
+    after the file is parsed, not listed here.
+*/
+#define CONFIG_FIELDS(X)             \
+    X(isTopSpine, bool,    "isTopSpine") \
+    X(tier,       uint8_t, "tier")       \
+    X(logLevel,   uint8_t, "logLevel")
+
 /*****************************************
  * FUNCTION PROTOTYPES 
  *****************************************/
 void readConfigurationFile(Config *config, const char* configFile);
 int isValidDirectory(const char *path);
-char* getFilePath(const char* directory, const char* name, const char* extension);
+int getFilePath(char* out, size_t cap, const char* directory, const char* name, const char* extension);
 
 #endif
\ No newline at end of file
@@ -1,52 +1,206 @@
 #include "logger.h"
 
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
 static log_mode_t current_log_mode = LOG_TO_CONSOLE;
-static FILE *log_file = NULL;
 
-void set_log_mode(log_mode_t mode, const char *file_path) 
+int log_level = MTP_LOG_DEBUG;
+
+/*
+    File logging runs through a single-producer/single-consumer ring: the main
+    loop formats each line into a slot and publishes it with a release store,
+    and a drain thread gathers pending slots into one writev() per batch. The
+    handlers therefore pay only the vsnprintf plus an atomic store — the
+    write syscalls happen off the packet-processing thread, amortized across
+    up to LOG_BATCH lines each.
+*/
+#define LOG_RING_SLOTS 4096 // Power of two; about 1 MiB of buffered lines.
+#define LOG_SLOT_LEN 240
+#define LOG_BATCH 64
+
+struct log_slot {
+    uint32_t len;
+    char buf[LOG_SLOT_LEN];
+};
+
+static struct log_slot log_ring[LOG_RING_SLOTS];
+static unsigned int ring_head = 0; // Next slot the producer writes. Producer-owned.
+static unsigned int ring_tail = 0; // Next slot the consumer drains. Consumer-owned.
+
+static int log_fd = -1;
+static int wake_fd = -1; // Kicked only on the empty->non-empty transition.
+static int drain_running = 0;
+static pthread_t drain_thread;
+
+static void* drain_log_ring(void* arg)
+{
+    (void)arg;
+
+    struct iovec iov[LOG_BATCH];
+
+    while(1)
+    {
+        unsigned int head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+
+        if(ring_tail == head)
+        {
+            if(!__atomic_load_n(&drain_running, __ATOMIC_ACQUIRE))
+            {
+                break; // Shut down only once every published line is written.
+            }
+
+            uint64_t kicks;
+            if(read(wake_fd, &kicks, sizeof(kicks)) < 0)
+            {
+                break;
+            }
+            continue;
+        }
+
+        // Walk a local copy of the tail; the shared tail must not move until
+        // writev has read the slots, or a producer spinning on the full-ring
+        // check could reuse them mid-write.
+        unsigned int tail = ring_tail;
+        int batched = 0;
+        while(tail != head && batched < LOG_BATCH)
+        {
+            struct log_slot* slot = &log_ring[tail & (LOG_RING_SLOTS - 1)];
+            iov[batched].iov_base = slot->buf;
+            iov[batched].iov_len = slot->len;
+            batched++;
+            tail++;
+        }
+
+        if(writev(log_fd, iov, batched) < 0)
+        {
+            perror("Log write failed");
+        }
+
+        // Free the drained slots for the producer.
+        __atomic_store_n(&ring_tail, tail, __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+void set_log_mode(log_mode_t mode, const char *file_path)
 {
     current_log_mode = mode;
 
-    if(mode == LOG_TO_FILE) 
+    if(mode == LOG_TO_FILE)
     {
-        log_file = fopen(file_path, "w");
+        log_fd = open(file_path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
 
-        if(log_file == NULL) 
+        if(log_fd < 0)
         {
             perror("Failed to open log file");
             exit(EXIT_FAILURE);
         }
-    } 
-    
-    else if(log_file != NULL) 
+
+        wake_fd = eventfd(0, 0);
+        if(wake_fd < 0)
+        {
+            perror("Failed to create log wakeup fd");
+            exit(EXIT_FAILURE);
+        }
+
+        drain_running = 1;
+        if(pthread_create(&drain_thread, NULL, drain_log_ring, NULL) != 0)
+        {
+            perror("Failed to start log drain thread");
+            exit(EXIT_FAILURE);
+        }
+
+        // The error paths exit() directly, which would tear down the drain
+        // thread with lines still queued in the ring. Draining on exit keeps
+        // those final lines; close_log_file is idempotent, so the normal
+        // signal-driven shutdown calling it first is fine.
+        static int exit_hook_registered = 0;
+        if(!exit_hook_registered)
+        {
+            exit_hook_registered = 1;
+            atexit(close_log_file);
+        }
+    }
+
+    else if(log_fd >= 0)
     {
-        fclose(log_file);
-        log_file = NULL;
+        close_log_file();
     }
 }
 
-void close_log_file() 
+void set_log_level(int level)
 {
-    if(log_file != NULL) 
+    log_level = level;
+}
+
+void close_log_file()
+{
+    if(log_fd >= 0)
     {
-        fclose(log_file);
-        log_file = NULL;
+        // Stop the drain thread after it has written everything pending.
+        __atomic_store_n(&drain_running, 0, __ATOMIC_RELEASE);
+        uint64_t kick = 1;
+        if(write(wake_fd, &kick, sizeof(kick)) < 0)
+        {
+            perror("Log wakeup failed");
+        }
+        pthread_join(drain_thread, NULL);
+
+        close(wake_fd);
+        wake_fd = -1;
+        close(log_fd);
+        log_fd = -1;
     }
 }
 
-void log_message(const char *format, ...) 
+void log_message(const char *format, ...)
 {
     va_list args;
     va_start(args, format);
-    if(current_log_mode == LOG_TO_CONSOLE) 
+    if(current_log_mode == LOG_TO_CONSOLE)
     {
         vprintf(format, args);
-    } 
-    
-    else if(current_log_mode == LOG_TO_FILE && log_file != NULL) 
+    }
+
+    else if(current_log_mode == LOG_TO_FILE && log_fd >= 0)
     {
-        vfprintf(log_file, format, args);
-        fflush(log_file);
+        unsigned int head = ring_head;
+
+        // Ring full: yield until the drain thread frees a slot rather than
+        // dropping lines the analysis scripts may depend on.
+        while(head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE) == LOG_RING_SLOTS)
+        {
+            sched_yield();
+        }
+
+        struct log_slot* slot = &log_ring[head & (LOG_RING_SLOTS - 1)];
+        int len = vsnprintf(slot->buf, LOG_SLOT_LEN, format, args);
+        if(len < 0)
+        {
+            len = 0;
+        }
+        slot->len = (uint32_t)(len < LOG_SLOT_LEN ? len : LOG_SLOT_LEN - 1);
+
+        __atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+
+        // Kick unconditionally. Gating this on an "empty ring" check races
+        // the drain thread's own empty check: both can read the other side's
+        // counter before the other side stores it, after which neither party
+        // ever kicks again and the ring wedges full. The eventfd write is a
+        // counter increment, so redundant kicks just coalesce, and one cheap
+        // syscall per line is still far below the old fflush-per-line cost.
+        uint64_t kick = 1;
+        if(write(wake_fd, &kick, sizeof(kick)) < 0)
+        {
+            perror("Log wakeup failed");
+        }
     }
 
     va_end(args);
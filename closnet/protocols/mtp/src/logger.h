@@ -14,22 +14,38 @@
 // None
 
 /*****************************************
- * CONSTANTS 
+ * CONSTANTS
  *****************************************/
-// None
+/*
+    Debug-level logging for hot loops. When the level is below MTP_LOG_DEBUG
+    the whole call reduces to one predicted-not-taken branch and the arguments
+    are never evaluated.
+*/
+#define LOG_DEBUG(...) \
+    do { if (__builtin_expect(log_level >= MTP_LOG_DEBUG, 0)) log_message(__VA_ARGS__); } while (0)
 
 /*****************************************
- * STRUCTURES 
+ * STRUCTURES
  *****************************************/
 typedef enum {
     LOG_TO_CONSOLE,
     LOG_TO_FILE
 } log_mode_t;
 
+typedef enum {
+    MTP_LOG_INFO = 0,
+    MTP_LOG_DEBUG = 1
+} log_level_t;
+
+// Current verbosity. Defaults to MTP_LOG_DEBUG, matching the historical
+// always-on logging that the experiment analysis scripts parse.
+extern int log_level;
+
 /*****************************************
- * FUNCTION PROTOTYPES 
+ * FUNCTION PROTOTYPES
  *****************************************/
 void set_log_mode(log_mode_t mode, const char *file_path);
+void set_log_level(int level);
 void close_log_file();
 void log_message(const char *format, ...);
 
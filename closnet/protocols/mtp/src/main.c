@@ -1,10 +1,16 @@
 /*
  * Standard library imports.
  */
+#define _GNU_SOURCE // recvmmsg() is a GNU extension.
 #include <stdint.h>
+#include <poll.h>
+#include <sys/mman.h>
 #include <stdlib.h>
 #include <time.h>
 #include <signal.h>
+#include <sys/signalfd.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 #include <unistd.h> 
 
 /*
@@ -23,64 +29,295 @@ Config mtpConfig = {0};
 uint8_t VID_octet = 3; // Third octet in IPv4 address, example: octet value C in address A.B.C.D
 char my_VID[VID_LEN] = {'\0'};
 char *nodeName;
+size_t nodeNameLen; // Cached so the per-packet prefix check never rescans the name.
 char *configDirectory;
 
 /*
  * Control Ports (MTP-speaking interfaces)
  */
 struct control_port *cp_head = NULL;
-struct control_port *cp_temp = NULL;
 
 /*
  * Compute Ports (IPv4-speaking interfaces)
  */
 compute_interface *compute_intf_head = NULL;
-compute_interface *compute_intf_temp = NULL;
 
 /*
  * Offered Ports (interfaces sending VIDs to upper tier devices).
  */
 struct VID_offered_port* vop_head = NULL;
-struct VID_offered_port* vop_temp = NULL;
 
 /*
  * Accepted Ports (interfaces receiving VIDs from lower tier devices).
  */
 struct VID_accepted_port* vap_head = NULL;
-struct VID_accepted_port* vap_temp = NULL;
 
 /*
- * Current clock time.
- */
-struct timeval current_time;
+ * Temporary storage for VIDs. The rows live in one contiguous BSS block so a
+ * cache line covers several VIDs; the pointer array on top keeps the existing
+ * char** call sites unchanged.
+*/
+#define TEMP_VID_ROWS 32
+static char temp_vid_storage[TEMP_VID_ROWS * VID_LEN];
+static char *temp_2d_array_storage[TEMP_VID_ROWS];
+static uint16_t temp_vid_values[TEMP_VID_ROWS]; // Integer VID scratch; the update pipeline carries values, not strings.
+char **temp_2d_array = temp_2d_array_storage;
+
+/*
+    Per-destination route cache for the data path. A steady flow asks the same
+    "which offered ports can reach this VID" question for every packet, so the
+    answer is memoized per destination VID and revalidated against
+    topology_gen, which every port-state or table mutation bumps. A hit costs
+    one compare instead of a walk over the offered-port list.
+*/
+#define VID_ROUTE_CACHE_SIZE 256
+static struct vid_route_entry {
+    uint16_t vid;
+    unsigned int gen;
+    size_t count;
+    struct control_port* ports[MAX_PORTS];
+} vid_route_cache[VID_ROUTE_CACHE_SIZE];
+
+static size_t lookup_available_ports(uint16_t dest_VID, struct control_port*** ports_out){
+    struct vid_route_entry* entry = &vid_route_cache[dest_VID & (VID_ROUTE_CACHE_SIZE - 1)];
+    if(entry->vid != dest_VID || entry->gen != topology_gen){
+        entry->vid = dest_VID;
+        entry->gen = topology_gen;
+        entry->count = collect_available_offered_ports(vop_head, entry->ports, dest_VID);
+    }
+    *ports_out = entry->ports;
+    return entry->count;
+}
+
+/*
+ * Working (up and running) interface names, refreshed each scan.
+*/
+intf_name_set working_ports;
 
 /*
- * Temporary storage for VIDs and interface names
+ * Scratch list of control ports collected for a batched failure fan-out.
 */
-char **temp_2d_array;
-char **temp_2d_port_array;
+struct control_port* fanout_ports[MAX_PORTS];
+
+// Bounds-checked append for the fan-out scratch array. The sources feeding it
+// are themselves capped at MAX_PORTS entries, so hitting the bound means the
+// caps are out of sync — fail loudly instead of overwriting adjacent state.
+static size_t fanout_add(size_t fanout, struct control_port* cp)
+{
+    if(fanout >= MAX_PORTS)
+    {
+        fprintf(stderr, "Fan-out overflow (max %d ports)\n", MAX_PORTS);
+        exit(EXIT_FAILURE);
+    }
+    fanout_ports[fanout] = cp;
+    return fanout + 1;
+}
 
 extern int socketfd;
 
 /*
  * Function prototypes to handle each type of MTP message that can be received.
+ * All handlers share one signature so dispatch can go through a flat table;
+ * handlers that do not need the buffer or length simply ignore them.
 */
-void handle_receive_hello_NR(unsigned char* recvBuffer_MTP,char* recvOnEtherPort);
-void handle_receive_join_req(unsigned char* recvBuffer_MTP,char* recvOnEtherPort);
-void handle_receive_join_res(unsigned char* recvBuffer_MTP,char* recvOnEtherPort);
-void handle_receive_join_ack(unsigned char* recvBuffer_MTP,char* recvOnEtherPort);
-void handle_receive_start_hello(char* recvOnEtherPort);
-void handle_receive_data_msg(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
-void handle_receive_keep_alive(char* recvOnEtherPort);
-void handle_receive_failure_update(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
-void handle_receive_recover_update(unsigned char* recvBuffer_MTP,char* recvOnEtherPort);
-void handle_receive_from_server(unsigned char* recvBuffer_IP,char* recvOnEtherPort, socklen_t recv_len_IP);
+void handle_receive_hello_NR(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
+void handle_receive_join_req(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
+void handle_receive_join_res(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
+void handle_receive_join_ack(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
+void handle_receive_start_hello(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
+void handle_receive_data_msg_leaf(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
+void handle_receive_data_msg_spine(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
+void handle_receive_keep_alive(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
+// The failure/recover handlers fire on topology events, not per packet; cold
+// keeps their code out of the lines the data-plane handlers execute from.
+__attribute__((cold, noinline)) void handle_receive_failure_update(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
+__attribute__((cold, noinline)) void handle_receive_recover_update(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP);
+__attribute__((hot)) void handle_receive_from_server(unsigned char* recvBuffer_IP,char* recvOnEtherPort, socklen_t recv_len_IP);
+
+/*
+    Dispatch table indexed by the MTP message type byte. The compare chain of
+    the old switch becomes one bounds-free load plus an indirect call, which
+    stays predictable for the hot types (KEEP_ALIVE, DATA_MSG). Unassigned
+    slots are NULL and the frame is dropped, matching the old default case.
+    The DATA_MSG slot is bound to the leaf or spine variant once the node's
+    role is known, baking the role decision out of the per-packet path.
+*/
+static void (*mtp_handlers[256])(unsigned char*, char*, socklen_t) = {
+    [MTP_TYPE_HELLONR_MSG]   = handle_receive_hello_NR,       // hello no response
+    [MTP_TYPE_JOIN_REQ]      = handle_receive_join_req,       // join request
+    [MTP_TYPE_JOIN_RES]      = handle_receive_join_res,       // join response
+    [MTP_TYPE_JOIN_ACK]      = handle_receive_join_ack,       // join acknowledge
+    [MTP_TYPE_START_HELLO]   = handle_receive_start_hello,    // start sending hello
+    [MTP_TYPE_KEEP_ALIVE]    = handle_receive_keep_alive,     // keep alive message
+    [MTP_TYPE_FAILURE_UPDATE]= handle_receive_failure_update, // failure message
+    [MTP_TYPE_RECOVER_UPDATE]= handle_receive_recover_update, // recover message
+};
+
+/*
+    Flood the appropriate FAILURE UPDATE set after failed_cp goes down. The
+    immediate-detect and missed-keep-alive sites share this three-way
+    decision; keeping the single copy out of line and cold leaves the
+    keep-alive scan itself as short straight-line code.
+*/
+__attribute__((cold)) static void fanout_failure(struct control_port *failed_cp)
+{
+    uint16_t numOfVID;
+    size_t fanout = 0;
+    struct VID_accepted_port* vap_temp;
+    struct VID_offered_port* vop_temp;
+
+    if(!mtpConfig.isTopSpine && is_all_offered_ports_down(vop_head)){
+        LOG_DEBUG("All upstream ports down, sending all accepted VIDs from downstream ports\n");
+        numOfVID = get_all_accepted_VIDs(vap_head, temp_vid_values);
+        for(vap_temp = vap_head;vap_temp;vap_temp = vap_temp->next){
+            if(vap_temp->cp->isUP){
+                fanout = fanout_add(fanout, vap_temp->cp);
+            }
+        }
+        send_failure_update_batch(fanout_ports, fanout, temp_vid_values, numOfVID, REACHABLE_OPTION);
+    }else if(find_accepted_port_by_name(vap_head,failed_cp->port_name)){
+        LOG_DEBUG("Failed on downstream port\n");
+        numOfVID = get_accepted_VIDs_by_port_name(vap_head, failed_cp->port_name, temp_vid_values);
+        for(size_t i = 0;i < cp_array_len;i++){
+            if(cp_array[i]->isUP){
+                fanout = fanout_add(fanout, cp_array[i]);
+            }
+        }
+        send_failure_update_batch(fanout_ports, fanout, temp_vid_values, numOfVID, UNREACHABLE_OPTION);
+    }else{ // upstream port
+        LOG_DEBUG("Failed on upstream port\n");
+        if(!is_unreachable_and_reachable_empty(vop_head)){
+            LOG_DEBUG("All upstream ports are not clean, sending blocked VID from downstream ports\n");
+            if((numOfVID = get_unreachable_VIDs_from_offered_ports(vop_head, temp_vid_values))){
+                for(vop_temp = vop_head;vop_temp;vop_temp = vop_temp->next){ // send black
+                    if(vop_temp->cp->isUP){
+                        fanout = fanout_add(fanout, vop_temp->cp);
+                    }
+                }
+                send_failure_update_batch(fanout_ports, fanout, temp_vid_values, numOfVID, UNREACHABLE_OPTION);
+            }
+        }else{
+            LOG_DEBUG("Some upstream ports are clean, DONE\n");
+        }
+    }
+}
 
 /*
- * Function prototype to handle SIGINT (SIGINT) and stopping MTP.
+ * Function prototype for stopping MTP; invoked from the main loop when a
+ * stop signal (SIGHUP/SIGINT/SIGTERM) arrives on the signalfd.
 */
 void handleSignal(int sig);
 
+/*
+    Attach a TPACKET_V3 receive ring to a packet socket and map it into the
+    process. The kernel then delivers frames by writing them into the ring
+    directly, removing the per-packet copy and syscall that recvfrom paid.
+*/
+static char* setupPacketRxRing(int sock)
+{
+    int version = TPACKET_V3;
+    if(setsockopt(sock, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+    {
+        perror("Error: PACKET_VERSION setsockopt()");
+        exit(1);
+    }
+
+    struct tpacket_req3 req;
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = RX_RING_BLOCK_SIZE;
+    req.tp_block_nr = RX_RING_BLOCK_NR;
+    req.tp_frame_size = RX_RING_FRAME_SIZE;
+    req.tp_frame_nr = (RX_RING_BLOCK_SIZE / RX_RING_FRAME_SIZE) * RX_RING_BLOCK_NR;
+    req.tp_retire_blk_tov = RX_RING_RETIRE_MS;
+
+    if(setsockopt(sock, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0)
+    {
+        perror("Error: PACKET_RX_RING setsockopt()");
+        exit(1);
+    }
+
+    char *ring = mmap(NULL, (size_t)RX_RING_BLOCK_SIZE * RX_RING_BLOCK_NR,
+                      PROT_READ | PROT_WRITE, MAP_SHARED, sock, 0);
+    if(ring == MAP_FAILED)
+    {
+        perror("Error: RX ring mmap()");
+        exit(1);
+    }
+
+    return ring;
+}
+
+/*
+    if_indextoname() costs a syscall per received frame. The interface set is
+    fixed before the main loop starts (Mininet creates every link up front),
+    so each port's index is resolved once and RX lookups become an array read.
+    Indexes past the cache bound do occur: a veth moved into this node's
+    namespace keeps the index it was allocated in the root namespace, which
+    grows with every link created since boot, so repeated experiment runs on
+    one host can push a port beyond MAX_IFINDEX. Those ports take the
+    baseline if_indextoname() syscall per frame instead of being dropped.
+*/
+static char ifname_cache[MAX_IFINDEX][IFNAMSIZ];
+
+static int resolve_recv_ifname(unsigned int ifindex, char *name_out)
+{
+    if(ifindex < MAX_IFINDEX && ifname_cache[ifindex][0] != '\0')
+    {
+        strcpy(name_out, ifname_cache[ifindex]);
+        return 1;
+    }
+    return if_indextoname(ifindex, name_out) != NULL;
+}
+
+static void build_ifname_cache(struct control_port *cp_list, compute_interface *ci_list)
+{
+    for(struct control_port *cp = cp_list; cp; cp = cp->next)
+    {
+        unsigned int index = if_nametoindex(cp->port_name);
+        if(index > 0 && index < MAX_IFINDEX)
+        {
+            strcpy(ifname_cache[index], cp->port_name);
+        }
+    }
+
+    for(compute_interface *ci = ci_list; ci; ci = ci->next)
+    {
+        unsigned int index = if_nametoindex(ci->port_name);
+        if(index > 0 && index < MAX_IFINDEX)
+        {
+            strcpy(ifname_cache[index], ci->port_name);
+        }
+    }
+}
+
+/*
+    Resolve the receiving interface of one MTP frame and dispatch it to the
+    handler for its message type. Bytes 0-13 are the Ethernet II header,
+    byte 14 starts the MTP header, whatever type it might be.
+*/
+static void dispatch_MTP_message(unsigned char *recvBuffer_MTP, int recv_len_MTP,
+                                 unsigned int ifindex, char *recvOnEtherPort)
+{
+    // Map the interface index to its name: cache first, syscall fallback.
+    if(!resolve_recv_ifname(ifindex, recvOnEtherPort))
+    {
+        return;
+    }
+
+    // If the message comes on an interface not in the form <nodeName>-ethX, do not process
+    if(memcmp(recvOnEtherPort, nodeName, nodeNameLen) != 0)
+    {
+        return;
+    }
+
+    uint8_t MSGType = recvBuffer_MTP[14];
+
+    if(mtp_handlers[MSGType])
+    {
+        mtp_handlers[MSGType](recvBuffer_MTP, recvOnEtherPort, (socklen_t)recv_len_MTP);
+    }
+}
+
 int main(int argc, char **argv)
 {
 
@@ -98,6 +335,7 @@ int main(int argc, char **argv)
     }
 
     nodeName = argv[1];
+    nodeNameLen = strlen(nodeName);
     configDirectory = argv[2];
 
     // If the inputted config directory is not valid, stop the program.
@@ -107,36 +345,72 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    // Set up a SIGHUP (signal hangup) handler to gracefully stop running MTP.
-    if(signal(SIGHUP, handleSignal) == SIG_ERR) 
+    /*
+        Route SIGHUP, SIGINT, and SIGTERM through a signalfd polled by the
+        main loop instead of async handlers. The shutdown path logs and writes
+        the downtime file — none of which is async-signal-safe — so running it
+        from loop context makes stopping MTP safe as well as race-free.
+    */
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGHUP);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+
+    if(sigprocmask(SIG_BLOCK, &stopSignals, NULL) < 0)
+    {
+        perror("sigprocmask");
+        exit(EXIT_FAILURE);
+    }
+
+    int sigfd = signalfd(-1, &stopSignals, SFD_CLOEXEC);
+    if(sigfd < 0)
     {
-        perror("signal");
+        perror("signalfd");
         exit(EXIT_FAILURE);
     }
 
-    // Set up a SIGINT (CTRL + C) handler to gracefully stop running MTP.
-    if(signal(SIGINT, handleSignal) == SIG_ERR)
+    /*
+        Link-change notifications. The working port set used for immediate
+        failure detection can only change when an interface flaps, so the loop
+        subscribes to rtnetlink link events and re-walks getifaddrs() just on
+        those, instead of on a timer.
+    */
+    int nlfd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if(nlfd < 0)
     {
-        perror("signal");
+        perror("Error: netlink socket()");
         exit(EXIT_FAILURE);
     }
 
-    // Set up a SIGTERM (signal terminate) handler to gracefully stop running MTP.
-    if (signal(SIGTERM, handleSignal) == SIG_ERR) 
+    struct sockaddr_nl nl_addr;
+    memset(&nl_addr, 0, sizeof(nl_addr));
+    nl_addr.nl_family = AF_NETLINK;
+    nl_addr.nl_groups = RTMGRP_LINK;
+
+    if(bind(nlfd, (struct sockaddr *)&nl_addr, sizeof(nl_addr)) < 0)
     {
-        perror("signal");
+        perror("Error: netlink bind()");
         exit(EXIT_FAILURE);
     }
 
-    // Read in the configuration for the MTP switch.
-    char* configFilePath = getFilePath(configDirectory, nodeName, CONF_EXT);
+    // Read in the configuration for the MTP switch. Verbosity defaults to
+    // debug — the historical always-on logging the analysis scripts parse —
+    // and an optional logLevel key in the config file dials it down.
+    char configFilePath[MAX_FILE_PATH_LENGTH];
+    getFilePath(configFilePath, sizeof(configFilePath), configDirectory, nodeName, CONF_EXT);
+    mtpConfig.logLevel = MTP_LOG_DEBUG;
     readConfigurationFile(&mtpConfig, configFilePath);
-    free(configFilePath);
+    set_log_level(mtpConfig.logLevel);
+
+    // Bind the DATA_MSG handler to this node's role now that it is known.
+    mtp_handlers[MTP_TYPE_DATA_MSG] = mtpConfig.isLeaf ? handle_receive_data_msg_leaf
+                                                       : handle_receive_data_msg_spine;
 
     // Set up logging
-    char* logFilePath = getFilePath(configDirectory, nodeName, LOG_EXT);
+    char logFilePath[MAX_FILE_PATH_LENGTH];
+    getFilePath(logFilePath, sizeof(logFilePath), configDirectory, nodeName, LOG_EXT);
     set_log_mode(LOG_TO_FILE, logFilePath);
-    free(logFilePath);
 
     /*  INTERFACE TYPE DEFINITION
         -----------------------------------------------------------------------------
@@ -152,11 +426,14 @@ int main(int argc, char **argv)
         exit(EXIT_FAILURE);
     }
 
-    // Find if a compute interface exists on the node and then find the control (MTP) interfaces.
-    compute_intf_head = setComputeInterfaces(ifaddr, mtpConfig.computeIntfName, mtpConfig.isLeaf, nodeName);
-    cp_head = setControlInterfaces(ifaddr, mtpConfig.computeIntfName, mtpConfig.isLeaf, nodeName);
+    // Find if a compute interface exists on the node and the control (MTP) interfaces in a single walk.
+    classifyInterfaces(ifaddr, mtpConfig.computeIntfName, mtpConfig.isLeaf, nodeName, &compute_intf_head, &cp_head);
     freeifaddrs(ifaddr); // Free the interface memory.
 
+    // The control port set is final now; build the name index the per-packet lookups use.
+    cp_index_build(cp_head);
+    build_ifname_cache(cp_head, compute_intf_head);
+
     log_message("\n===MTP START-UP CONFIG===\ntier = %d\nisTopSpine = %d\nisLeaf = %d\ncomputeIntfName = %s\n", 
             mtpConfig.tier, mtpConfig.isTopSpine, mtpConfig.isLeaf, mtpConfig.computeIntfName);
 
@@ -174,22 +451,14 @@ int main(int argc, char **argv)
 
     print_control_port_table(cp_head);
 
-    // TO-DO: Ask Vincent about the magic number 32, and why is the port array being given VID_LEN?
     // Initalize an array to add VIDs to as necessary (this also is used for ports sometimes?).
-    temp_2d_array = malloc(32 * sizeof(char*));
-    for(int j = 0; j < 10; j++)
+    // Every row is wired up front; the old heap version only initialized the
+    // first 10 of 32 pointers, leaving the rest as traps for larger topologies.
+    for(int j = 0; j < TEMP_VID_ROWS; j++)
     {
-        temp_2d_array[j] = malloc(VID_LEN);
-        memset(temp_2d_array[j], '\0', VID_LEN);
-    }
-
-    // Initalize an array to add interface names to as necessary.
-    temp_2d_port_array = malloc(32 * sizeof(char*));
-    for(int j = 0; j < 32; j++)
-    {
-        temp_2d_port_array[j] = malloc(VID_LEN);
-        memset(temp_2d_port_array[j], '\0', VID_LEN);
+        temp_2d_array[j] = &temp_vid_storage[j * VID_LEN];
     }
+    memset(temp_vid_storage, '\0', sizeof(temp_vid_storage));
 
     // Create a socket for MTP messages from MTP-speaking (tier 1+) neighbors.
     int sockMTP = 0;
@@ -199,6 +468,10 @@ int main(int argc, char **argv)
 		exit(1);
 	}
 
+    // MTP frames are received zero-copy through a kernel ring mapped into the process.
+    char *ring_MTP = setupPacketRxRing(sockMTP);
+    unsigned int ringBlock_MTP = 0; // Next ring block to check for retired frames.
+
     // Create socket for IPv4 packets from compute (tier 0) systems.
     int sockIP  = 0; 
     if((sockIP = socket(AF_PACKET, SOCK_RAW, htons (ETH_IP_CTRL))) < 0)
@@ -259,219 +532,212 @@ int main(int argc, char **argv)
         sleep(3);
 
         // Begin telling tier 2 spines about the existence of this leaf via Hello No-Response (Hello NR) messages 
-        for(cp_temp = cp_head; cp_temp; cp_temp = cp_temp->next)
+        for(struct control_port* cp_temp = cp_head; cp_temp; cp_temp = cp_temp->next)
         { 
             send_hello_NR(cp_temp->port_name,temp_2d_array,1);
         }
     }
 
     char recvOnEtherPort[ETH_LEN] = {'\0'}; // Interface name a message is received on.
-    uint16_t numOfVID = 0; // Used to count the number of VIDs on a given interface and table.
 
-    // Prep MTP message socket.
-    int recv_len_MTP = 0;
-    unsigned char recvBuffer_MTP[MAX_BUFFER_SIZE] = { '\0' };
-    struct sockaddr_ll src_addr_MTP; // sockaddr_ll - a structure device-independent physical-layer address
-    socklen_t addr_len_MTP = sizeof(src_addr_MTP); //  socklen_t - an unsigned opaque integral type of length of at least 32 bits
+    /*
+        Prep IPv4 packet socket. recvmmsg() drains up to RECV_BURST frames per
+        syscall into this fixed pool of buffers, amortizing the kernel crossing
+        across a burst instead of paying one recvfrom() per packet.
+
+        Together with the mmap'd MTP ring above, all receive buffers are
+        preallocated for the life of the process and recycled in place: a
+        burst's buffers are free again once its handlers return, and ring
+        frames go back to the kernel when their block is released. Nothing on
+        the RX path allocates or frees per packet.
+    */
+    static struct mmsghdr msgs_IP[RECV_BURST];
+    static struct iovec iov_IP[RECV_BURST];
+    static unsigned char bufs_IP[RECV_BURST][MAX_BUFFER_SIZE];
+    static struct sockaddr_ll addrs_IP[RECV_BURST]; // sockaddr_ll - a structure device-independent physical-layer address
+
+    for(int i = 0; i < RECV_BURST; i++)
+    {
+        iov_IP[i].iov_base = bufs_IP[i];
+        iov_IP[i].iov_len = MAX_BUFFER_SIZE;
+        msgs_IP[i].msg_hdr.msg_iov = &iov_IP[i];
+        msgs_IP[i].msg_hdr.msg_iovlen = 1;
+        msgs_IP[i].msg_hdr.msg_name = &addrs_IP[i];
+        msgs_IP[i].msg_hdr.msg_namelen = sizeof(addrs_IP[i]);
+    }
+
+    /*
+        Wait set for the main loop. Instead of spinning on MSG_DONTWAIT and
+        burning a core at idle, the loop blocks in poll() until a socket is
+        readable or POLL_TIMEOUT_MS elapses; the timeout bounds how stale the
+        keep-alive and failure-detection work below can get. Spines never read
+        the IPv4 socket, so only leaves include it in the set. Stop signals
+        and link events arrive through their own fds alongside the sockets.
+    */
+    struct pollfd pfds[4] = {
+        { .fd = sigfd,   .events = POLLIN },
+        { .fd = sockMTP, .events = POLLIN },
+        { .fd = nlfd,    .events = POLLIN },
+        { .fd = sockIP,  .events = POLLIN }
+    };
+    nfds_t nfds = mtpConfig.isLeaf ? 4 : 3;
 
-    // Prep IPv4 packet socket.
-    int recv_len_IP = 0;
-    unsigned char recvBuffer_IP[MAX_BUFFER_SIZE] = { '\0' };
-    struct sockaddr_ll src_addr_IP; // sockaddr_ll - a structure device-independent physical-layer address
-    socklen_t addr_len_IP = sizeof(src_addr_IP); 
+    // Seed the working port set once; rtnetlink refreshes it from here on.
+    get_all_ethernet_interface2(&working_ports, nodeName);
 
     // Receive and send messages until the MTP implementation is stopped.
     while(1)
     {
-        recv_len_MTP = recvfrom(sockMTP, recvBuffer_MTP, MAX_BUFFER_SIZE, MSG_DONTWAIT, (struct sockaddr*) &src_addr_MTP, &addr_len_MTP); // listening MTP packet
+        poll(pfds, nfds, POLL_TIMEOUT_MS);
 
-        // If the incoming frame has data, parse and analyze it.
-        if(recv_len_MTP > 0)
-        {                                   
-            unsigned int tcIP = src_addr_MTP.sll_ifindex;
-            if_indextoname(tcIP, recvOnEtherPort);     // if_indextoname - map a network interface index to its corresponding name,built in fn.
-                // change name new_node - new connection    
+        // A pending stop signal shuts MTP down from normal loop context.
+        if(pfds[0].revents & POLLIN)
+        {
+            struct signalfd_siginfo ssi;
+            if(read(sigfd, &ssi, sizeof(ssi)) == sizeof(ssi))
+            {
+                handleSignal((int)ssi.ssi_signo);
+            }
+        }
+
+        // A link event is the only thing that can change the working port
+        // set; drain the notifications and rebuild it once per batch.
+        if(pfds[2].revents & POLLIN)
+        {
+            char nl_buf[4096];
+            while(recv(nlfd, nl_buf, sizeof(nl_buf), MSG_DONTWAIT) > 0){}
+            get_all_ethernet_interface2(&working_ports, nodeName);
+        }
+
+        /*
+            Walk every RX ring block the kernel has retired to userspace,
+            dispatching the frames in arrival order straight out of the ring.
+            A block only goes back to the kernel once its frames are handled,
+            so nothing here copies the frame first.
+        */
+        while(1)
+        {
+            struct tpacket_block_desc *pbd =
+                (struct tpacket_block_desc *)(ring_MTP + (size_t)ringBlock_MTP * RX_RING_BLOCK_SIZE);
 
-            // If the message comes on an interface not in the form <nodeName>-ethX, do not process
-            if(strncmp(recvOnEtherPort, nodeName, strlen(nodeName)) != 0)
-            { 
-                continue;
+            if(!(pbd->hdr.bh1.block_status & TP_STATUS_USER))
+            {
+                break; // The next block still belongs to the kernel, ring is drained.
             }
 
-            // Bytes 0-13 are the Ethernet II header, byte 14 starts the MTP header, whatever type it might be.
-            uint8_t MSGType = recvBuffer_MTP[14];
+            uint32_t numPkts = pbd->hdr.bh1.num_pkts;
+            struct tpacket3_hdr *framehdr =
+                (struct tpacket3_hdr *)((char *)pbd + pbd->hdr.bh1.offset_to_first_pkt);
 
-            switch(MSGType)
+            for(uint32_t p = 0; p < numPkts; p++)
             {
-                case MTP_TYPE_HELLONR_MSG:
-                    handle_receive_hello_NR(recvBuffer_MTP, recvOnEtherPort); // hello no response
-                    break;
-                case MTP_TYPE_JOIN_REQ:
-                    handle_receive_join_req(recvBuffer_MTP, recvOnEtherPort); // join request
-                    break; 
-                case MTP_TYPE_JOIN_RES:
-                    handle_receive_join_res(recvBuffer_MTP, recvOnEtherPort); // join response
-                    break;                                 
-                case MTP_TYPE_JOIN_ACK: 
-                    handle_receive_join_ack(recvBuffer_MTP, recvOnEtherPort); // join acknowledge
-                    break;
-                case MTP_TYPE_START_HELLO:
-                    handle_receive_start_hello(recvOnEtherPort);              // start sending hello
-                    break;
-                case MTP_TYPE_DATA_MSG:                                       // compute node data
-                    handle_receive_data_msg(recvBuffer_MTP, recvOnEtherPort,recv_len_MTP); 
-                    break;
-                case MTP_TYPE_KEEP_ALIVE:
-                    handle_receive_keep_alive(recvOnEtherPort);               // keep alive message
-                    break;
-                case MTP_TYPE_FAILURE_UPDATE: 
-                    handle_receive_failure_update(recvBuffer_MTP, recvOnEtherPort,recv_len_MTP); // failure message
-                    break;
-                case MTP_TYPE_RECOVER_UPDATE:
-                    handle_receive_recover_update(recvBuffer_MTP, recvOnEtherPort);              // recover message
-                    break;
-                default:
-                    break;
+                // The link-layer source address sits right after the frame header.
+                struct sockaddr_ll *sll =
+                    (struct sockaddr_ll *)((char *)framehdr + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+
+                dispatch_MTP_message((unsigned char *)framehdr + framehdr->tp_mac,
+                                     (int)framehdr->tp_snaplen, sll->sll_ifindex, recvOnEtherPort);
+
+                framehdr = (struct tpacket3_hdr *)((char *)framehdr + framehdr->tp_next_offset);
             }
+
+            // Hand the block back to the kernel for reuse.
+            pbd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+            __sync_synchronize();
+            ringBlock_MTP = (ringBlock_MTP + 1) % RX_RING_BLOCK_NR;
         }
 
         // Only the leaf listens to compute device IPv4 traffic.
         if(mtpConfig.isLeaf)
         {
-            recv_len_IP = recvfrom(sockIP, recvBuffer_IP, MAX_BUFFER_SIZE, MSG_DONTWAIT, (struct sockaddr*) &src_addr_IP, &addr_len_IP);
-            
-            if(recv_len_IP > 0)
+            int burst_IP = recvmmsg(sockIP, msgs_IP, RECV_BURST, MSG_DONTWAIT, NULL);
+
+            for(int m = 0; m < burst_IP; m++)
             {
-                unsigned int tcIP = src_addr_IP.sll_ifindex;
-                
-                if_indextoname(tcIP, recvOnEtherPort); // Map a network interface index to its corresponding name.
+                unsigned char *recvBuffer_IP = bufs_IP[m];
+                int recv_len_IP = (int)msgs_IP[m].msg_len;
 
-                if(strncmp(recvOnEtherPort, nodeName, strlen(nodeName)) != 0)
-                { 
+                msgs_IP[m].msg_hdr.msg_namelen = sizeof(addrs_IP[m]);
+
+                unsigned int tcIP = addrs_IP[m].sll_ifindex;
+
+                // Map the interface index to its name: cache first, syscall fallback.
+                if(!resolve_recv_ifname(tcIP, recvOnEtherPort))
+                {
                     continue;
                 }
-                
+
+                if(memcmp(recvOnEtherPort, nodeName, nodeNameLen) != 0)
+                {
+                    continue;
+                }
+
                 handle_receive_from_server(recvBuffer_IP,recvOnEtherPort, recv_len_IP); // send data msg here
             }
         }
 
-        // Send KEEP ALIVE and check the fail of the port
-        uint8_t working_port_num = get_all_ethernet_interface2(temp_2d_port_array, nodeName);
-        for(cp_temp = cp_head;cp_temp;cp_temp = cp_temp->next)
+        /*
+            Send KEEP ALIVE and check the fail of the port. The working port
+            set is event-driven (see the netlink fd above), so this pass reads
+            it without any kernel walk of its own.
+        */
+        long long now_ms = get_milli_sec();
+        for(size_t port_i = 0;port_i < cp_array_len;port_i++)
         {
+            struct control_port* cp_temp = cp_array[port_i];
             if(!cp_temp->start) continue;
 
             if(cp_temp->last_received_time){ // run the code in this block after received first keep alive message
 
-                int alive = check_port_is_alive(temp_2d_port_array,working_port_num,cp_temp->port_name); // immediate detect
+                int alive = check_port_is_alive(&working_ports, cp_temp->port_name); // immediate detect
                 
                 // port fail
                 if(!alive && cp_temp->isUP)
                 { 
                     // from up to down
                     cp_temp->isUP = 0;
+                    topology_gen++;
                     cp_temp->fail_type = DETECT_FAIL;
                     cp_temp->continue_count = 0; // reset continue count
                     log_message("Stop sending and receiving message due to immediate failure\n");
-                    log_message("Detected a failure, shut down port %s at time %lld\n",cp_temp->port_name,get_milli_sec(&current_time));
+                    log_message("Detected a failure, shut down port %s at time %lld\n",cp_temp->port_name,get_milli_sec_precise());
 
-                    if(!mtpConfig.isTopSpine && is_all_offered_ports_down(vop_head)){
-                        log_message("All upstream ports down, sending all accepted VIDs from downstream ports\n");
-                        numOfVID = get_all_accepted_VIDs(vap_head, temp_2d_array);
-                        for(vap_temp = vap_head;vap_temp;vap_temp = vap_temp->next){
-                            if(vap_temp->cp->isUP){
-                                send_failure_update(vap_temp->port_name, temp_2d_array,numOfVID, REACHABLE_OPTION);
-                            }
-                        }
-                    }else if(find_accepted_port_by_name(vap_head,cp_temp->port_name)){
-                        log_message("Failed on downstream port\n");
-                        numOfVID = get_accepted_VIDs_by_port_name(vap_head, cp_temp->port_name, temp_2d_array);
-                        for(struct control_port* cp_temp2 = cp_head;cp_temp2;cp_temp2 = cp_temp2->next){
-                            if(cp_temp2->isUP){
-                                send_failure_update(cp_temp2->port_name,temp_2d_array,numOfVID, UNREACHABLE_OPTION);                
-                            }
-                        }        
-                    }else{ // upstream port
-                        log_message("Failed on upstream port\n");
-                        if(!is_unreachable_and_reachable_empty(vop_head)){
-                            log_message("All upstream ports are not clean, sending blocked VID from downstream ports\n");
-                            if((numOfVID = get_unreachable_VIDs_from_offered_ports(vop_head, temp_2d_array))){
-                                for(vop_temp = vop_head;vop_temp;vop_temp = vop_temp->next){ // send black 
-                                    if(vop_temp->cp->isUP){
-                                        send_failure_update(vop_temp->port_name, temp_2d_array, numOfVID, UNREACHABLE_OPTION);
-                                    }
-                                }
-                            }
-                        }else{
-                            log_message("Some upstream ports are clean, DONE\n");
-                        }    
-                    }
+                    fanout_failure(cp_temp);
                 }
 
                 // port come back
                 else if(alive && cp_temp->fail_type == DETECT_FAIL)
                 { 
-                    log_message("\nPort %s is back at time %lld\n",cp_temp->port_name,get_milli_sec(&current_time));
+                    log_message("\nPort %s is back at time %lld\n",cp_temp->port_name,get_milli_sec_precise());
                     cp_temp->fail_type = 0;
                 }
 
                 if(cp_temp->fail_type) continue;
 
-                long long received_time_diff = get_milli_sec(&current_time) - cp_temp->last_received_time;
+                long long received_time_diff = now_ms - cp_temp->last_received_time;
 
                 if(received_time_diff >= DEAD_TIMER && cp_temp->isUP){ // check whether exceed dead timer
                     log_message("Last receive time is %lld\n",cp_temp->last_received_time);
-                    log_message("--------Disabled for port %s due to a missing KEEP ALIVE at time %lld--------\n",cp_temp->port_name,get_milli_sec(&current_time));
+                    log_message("--------Disabled for port %s due to a missing KEEP ALIVE at time %lld--------\n",cp_temp->port_name,get_milli_sec_precise());
                     cp_temp->continue_count = 0; // reset continue count
                     cp_temp->isUP = 0;
+                    topology_gen++;
                     cp_temp->fail_type = MISS_FAIL;
 
                     log_message("Stop sending and receiving message due to missing hello\n");
 
                     log_message("Sending FAILURE UPDATE message from other working ports\n");
-                    if(!mtpConfig.isTopSpine && is_all_offered_ports_down(vop_head)){
-                        log_message("All upstream ports down, sending all accepted VIDs from downstream ports\n");
-                        numOfVID = get_all_accepted_VIDs(vap_head, temp_2d_array);
-                        for(vap_temp = vap_head;vap_temp;vap_temp = vap_temp->next){
-                            if(vap_temp->cp->isUP){
-                                send_failure_update(vap_temp->port_name, temp_2d_array,numOfVID, REACHABLE_OPTION);
-                            }
-                        }
-                    }else if(find_accepted_port_by_name(vap_head,cp_temp->port_name)){
-                        log_message("Failed on downstream port\n");
-                        numOfVID = get_accepted_VIDs_by_port_name(vap_head, cp_temp->port_name, temp_2d_array);
-                        for(struct control_port* cp_temp2 = cp_head;cp_temp2;cp_temp2 = cp_temp2->next){
-                            if(cp_temp2->isUP){
-                                send_failure_update(cp_temp2->port_name,temp_2d_array,numOfVID, UNREACHABLE_OPTION);                
-                            }
-                        }        
-                    }else{ // upstream port
-                        log_message("Failed on upstream ports\n");
-                        if(!is_unreachable_and_reachable_empty(vop_head)){
-                            log_message("All upstream ports are not clean, sending blocked VID from downstream ports\n");
-                            if((numOfVID = get_unreachable_VIDs_from_offered_ports(vop_head, temp_2d_array))){
-                                log_message("Sending %d BLACK VID\n",numOfVID);
-                                for(vop_temp = vop_head;vop_temp;vop_temp = vop_temp->next){ // send black 
-                                    if(vop_temp->cp->isUP){
-                                        send_failure_update(vop_temp->port_name, temp_2d_array, numOfVID, UNREACHABLE_OPTION);
-                                    }
-                                }
-                            }
-                        }else{
-                            log_message("Some upstream ports are clean, DONE\n"); 
-                        }   
-                    }
+                    fanout_failure(cp_temp);
                     continue;
                 }
             }
 
-            long long current_timestamp = get_milli_sec(&current_time);
             // send hello keep live
-            if(current_timestamp - cp_temp->last_sent_time >= HELLO_TIMER){ // send keep alive message if condition met
-                // log_message("Send before time %lld\n",current_timestamp);
+            if(now_ms - cp_temp->last_sent_time >= HELLO_TIMER){ // send keep alive message if condition met
+                // log_message("Send before time %lld\n",now_ms);
                 if(send_keep_alive(cp_temp->port_name) != -1){ // send here
-                    // log_message("Sent KEEP ALIVE at time = %lld, update last sent time for port %s \n",get_milli_sec(&current_time),cp_temp->port_name);
-                    cp_temp->last_sent_time = get_milli_sec(&current_time); // update send time
+                    // log_message("Sent KEEP ALIVE at time = %lld, update last sent time for port %s \n",now_ms,cp_temp->port_name);
+                    cp_temp->last_sent_time = now_ms; // update send time
                 }
             }
         } // End of control port status check for loop.
@@ -481,7 +747,7 @@ int main(int argc, char **argv)
 
 void handleSignal(int sig)
 {
-    long long current_timestamp = get_milli_sec(&current_time);
+    long long current_timestamp = get_milli_sec_precise();
 
     log_message("\nMTP STOPPED [%lld]\n",current_timestamp);
     // To-Do: Add memory-freeing calls here (control and compute interfaces, temp arrays, etc.)
@@ -489,7 +755,8 @@ void handleSignal(int sig)
     // If file logging is currently enabled, close the file
     close_log_file();
 
-    char* downFilePath = getFilePath(configDirectory, nodeName, DOWN_EXT);
+    char downFilePath[MAX_FILE_PATH_LENGTH];
+    getFilePath(downFilePath, sizeof(downFilePath), configDirectory, nodeName, DOWN_EXT);
     FILE* fptr;
     fptr = fopen(downFilePath, "w");
 
@@ -504,27 +771,26 @@ void handleSignal(int sig)
     fprintf(fptr,"%lld\n", current_timestamp);
     fflush(fptr);
     fclose(fptr);
-    free(downFilePath);
 
     exit(EXIT_SUCCESS);
 }
 
-void handle_receive_hello_NR(unsigned char* recvBuffer_MTP, char* recvOnEtherPort){
+void handle_receive_hello_NR(unsigned char* recvBuffer_MTP, char* recvOnEtherPort, socklen_t recv_len_MTP){
     if(get_tier_from_hello_message(recvBuffer_MTP + 15) >= mtpConfig.tier){ // break the case if the message from higher tier
-        // log_message("\nReceived HelloNR from higher tier, ignored!\n");
+        // LOG_DEBUG("\nReceived HelloNR from higher tier, ignored!\n");
         return;
     }
 
-    log_message("\n Hello no response Received\n");
+    LOG_DEBUG("\n Hello no response Received\n");
 
     uint16_t numOfVID = extract_VID_from_receive_buff(temp_2d_array,recvBuffer_MTP + 15,0);
     
     send_join_req( recvOnEtherPort, temp_2d_array,numOfVID); 
 }
 
-void handle_receive_join_req(unsigned char* recvBuffer_MTP,char* recvOnEtherPort)
+void handle_receive_join_req(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP)
 {
-    log_message("\n Join Request Received\n");
+    LOG_DEBUG("\n Join Request Received\n");
 
     uint16_t numOfVID = extract_VID_from_receive_buff(temp_2d_array,recvBuffer_MTP + 15,0);
 
@@ -537,9 +803,10 @@ void handle_receive_join_req(unsigned char* recvBuffer_MTP,char* recvOnEtherPort
     send_join_res(recvOnEtherPort,temp_2d_array,numOfVID); 
 }
 
-void handle_receive_join_res(unsigned char* recvBuffer_MTP,char* recvOnEtherPort){
-    log_message("\n Join Response Received\n");
+void handle_receive_join_res(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP){
+    LOG_DEBUG("\n Join Response Received\n");
     
+    struct VID_accepted_port* vap_temp;
     uint16_t numOfVID = extract_VID_from_receive_buff(temp_2d_array,recvBuffer_MTP + 15,0);
 
     
@@ -547,16 +814,18 @@ void handle_receive_join_res(unsigned char* recvBuffer_MTP,char* recvOnEtherPort
         vap_head = add_to_accepted_table(vap_head, recvOnEtherPort, temp_2d_array[i]);
     }
 
-    print_accepted_table(vap_head); // print the accepted table for debug
+    if(log_level >= MTP_LOG_DEBUG)
+    {
+        print_accepted_table(vap_head); // print the accepted table for debug
+    }
 
     vap_temp = find_accepted_port_by_name(vap_head, recvOnEtherPort);
     if(!vap_temp->cp){
-        cp_temp = find_control_port_by_name(cp_head,recvOnEtherPort);
-        vap_temp->cp = cp_temp;
+        vap_temp->cp = cp_lookup(recvOnEtherPort);
     }
 
     if(!mtpConfig.isTopSpine){ // send helloNR from spine to next tier spine 
-        for(cp_temp = cp_head;cp_temp;cp_temp = cp_temp->next){
+        for(struct control_port* cp_temp = cp_head;cp_temp;cp_temp = cp_temp->next){
             send_hello_NR(cp_temp->port_name, temp_2d_array, numOfVID);
         }
     }
@@ -565,22 +834,27 @@ void handle_receive_join_res(unsigned char* recvBuffer_MTP,char* recvOnEtherPort
 }
 
 
-void handle_receive_join_ack(unsigned char* recvBuffer_MTP,char* recvOnEtherPort){
-    log_message("\n Join Accept Received\n");       
+void handle_receive_join_ack(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP){
+    LOG_DEBUG("\n Join Accept Received\n");       
 
+    struct VID_offered_port* vop_temp;
     uint16_t numOfVID = extract_VID_from_receive_buff(temp_2d_array,recvBuffer_MTP + 15,0);
 
     for(uint16_t i = 0;i < numOfVID;i++){ // add new VIDs to offered table
         vop_head = add_to_offered_table(vop_head,recvOnEtherPort,temp_2d_array[i]);
     }
 
-    print_offered_table(vop_head);
+    if(log_level >= MTP_LOG_DEBUG)
+    {
+        print_offered_table(vop_head);
+    }
 
     vop_temp = find_offered_port_by_name(vop_head, recvOnEtherPort);
     if(!vop_temp->cp){ // turn on this port for transferring data message
-        cp_temp = find_control_port_by_name(cp_head,recvOnEtherPort);
+        struct control_port* cp_temp = cp_lookup(recvOnEtherPort);
         vop_temp->cp = cp_temp;
         cp_temp->isUP = 1;
+        topology_gen++;
         cp_temp->start = 1;
     }
     
@@ -588,43 +862,53 @@ void handle_receive_join_ack(unsigned char* recvBuffer_MTP,char* recvOnEtherPort
 }
 
 
-void handle_receive_start_hello(char* recvOnEtherPort){
+void handle_receive_start_hello(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP){
     
     // turn on the port
-    cp_temp = find_control_port_by_name(cp_head,recvOnEtherPort);
+    struct control_port* cp_temp = cp_lookup(recvOnEtherPort);
     cp_temp->isUP = 1;
+    topology_gen++;
     cp_temp->start = 1;
 }
 
 
-void handle_receive_data_msg(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP)
+/*
+    The node's role is fixed for the life of the process, so the DATA_MSG
+    dispatch slot is bound to the matching variant once at startup and the
+    per-packet role branch disappears from the forwarding path.
+*/
+void handle_receive_data_msg_leaf(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP)
 {
-    log_message("\nData message Received\n");
+    LOG_DEBUG("\nData message Received\n");
 
     // Find the control port that received the MTP data message and when it last received an MTP message / keep-alive.
-    cp_temp = find_control_port_by_name(cp_head, recvOnEtherPort);
-    cp_temp->last_received_time = get_milli_sec(&current_time);
+    struct control_port* cp_temp = cp_lookup(recvOnEtherPort);
+    cp_temp->last_received_time = get_milli_sec();
 
-    // If this node is a leaf, strip the MTP header from the message and forward it to the appropriate server.
-    if(mtpConfig.isLeaf)
-    { 
-        /* 
-            Currently, the manually-set computeIntfName is used because only one compute interface is used for testing, saving resources and time. 
+    // A leaf strips the MTP header from the message and forwards it to the appropriate server.
+    /* 
+        Currently, the manually-set computeIntfName is used because only one compute interface is used for testing, saving resources and time. 
 
-            The payload breakdown is as follows.
-            recvBuffer_MTP:
-                Ethernet II (14 bytes) - bytes 0-13
-                MTP Data Header (5 bytes) - bytes 14-18
-                payload - bytes 19+
+        The payload breakdown is as follows.
+        recvBuffer_MTP:
+            Ethernet II (14 bytes) - bytes 0-13
+            MTP Data Header (5 bytes) - bytes 14-18
+            payload - bytes 19+
 
-            Thus, starting at buffer position 0 (recvBuffer_MTP), +19 (14 + 5) gets you to the payload, which is normally IPv4 header.
-        */
-        route_data_to_server(mtpConfig.computeIntfName, recvBuffer_MTP + 14 + 5, recv_len_MTP - 14 - 5);
-    }
+        Thus, starting at buffer position 0 (recvBuffer_MTP), +19 (14 + 5) gets you to the payload, which is normally IPv4 header.
+    */
+    route_data_to_server(mtpConfig.computeIntfName, recvBuffer_MTP + 14 + 5, recv_len_MTP - 14 - 5);
+}
 
-    // If this node is a spine, forward the message to either any available spine at the next tier, or to a specific spine at the tier below. 
-    else
-    { 
+// A spine forwards the message to either any available spine at the next tier, or to a specific spine at the tier below.
+void handle_receive_data_msg_spine(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP)
+{
+    LOG_DEBUG("\nData message Received\n");
+
+    struct control_port* cp_temp = cp_lookup(recvOnEtherPort);
+    cp_temp->last_received_time = get_milli_sec();
+
+    {
         uint16_t src_VID = 0;
         uint16_t dest_VID = 0;
 
@@ -635,20 +919,21 @@ void handle_receive_data_msg(unsigned char* recvBuffer_MTP,char* recvOnEtherPort
 
         int_to_str(dest_VID_str, dest_VID);
 
-        log_message("Src VID = %d\n",src_VID);
-        log_message("Dest VID = %d\n",dest_VID);
+        LOG_DEBUG("Src VID = %d\n",src_VID);
+        LOG_DEBUG("Dest VID = %d\n",dest_VID);
         
         
         // check accepted ports first
+        struct VID_accepted_port* vap_temp;
         if((vap_temp = find_accepted_port_by_VID(vap_head,dest_VID_str))){ // if dest VID exist in accepted port table
-            log_message("Found VID in VID_Accepted_Table \n");
+            LOG_DEBUG("Found VID in VID_Accepted_Table \n");
 
             if(!vap_temp->cp->isUP || find_unreachable_VID_by_name(vap_temp->ut, vap_temp->port_name)){
-                log_message("But this port is down or unreachable for VID %s, dumped packet\n",dest_VID_str);
+                LOG_DEBUG("But this port is down or unreachable for VID %s, dumped packet\n",dest_VID_str);
                 return;
             }
-            find_control_port_by_name(cp_head,vap_temp->port_name)->last_sent_time = get_milli_sec(&current_time);
-            // log_message("Sent data message at time = %lld, update port sent time\n",t);
+            cp_lookup(vap_temp->port_name)->last_sent_time = get_milli_sec();
+            // LOG_DEBUG("Sent data message at time = %lld, update port sent time\n",t);
 
             route_data_from_spine(vap_temp->port_name,recvBuffer_MTP + 14,recv_len_MTP - 14);
         }else{ // else push up, pick one from offered port table
@@ -669,81 +954,100 @@ void handle_receive_data_msg(unsigned char* recvBuffer_MTP,char* recvOnEtherPort
             hash_str[2] = dest_ip_3;
             hash_str[3] = dest_ip_4;
             
-            size_t available_offered_port_num = count_available_offered_port(vop_head,temp_2d_array,dest_VID_str);
+            struct control_port** route_ports;
+            size_t available_offered_port_num = lookup_available_ports(dest_VID,&route_ports);
             if(!available_offered_port_num){
-                log_message("Found 0 available port, packet dumped\n");
+                LOG_DEBUG("Found 0 available port, packet dumped\n");
                 return;
             }
 
-            uint32_t hash_code = jenkins_one_at_a_time_hash(hash_str,4);
-            log_message("VID can't be found in accepted port table, push up to next spine\n");
-            log_message("available_offered_port_num = %lu\n",available_offered_port_num);
-            log_message("Hash ascii value array = {%d,%d,%d,%d}, hash_code = %u\n", hash_str[0], hash_str[1], hash_str[2], hash_str[3],hash_code);
-            log_message("Mod pos index = %lu\n",hash_code % available_offered_port_num);
-            find_control_port_by_name(cp_head,temp_2d_array[hash_code % available_offered_port_num])->last_sent_time = get_milli_sec(&current_time);
-            // log_message("Sent data message at time = %lld, update port sent time\n",t);
-            route_data_from_spine(temp_2d_array[hash_code % available_offered_port_num],recvBuffer_MTP + 14,recv_len_MTP - 14);
+            uint32_t flow_key;
+            memcpy(&flow_key, hash_str, 4);
+            uint32_t hash_code = flow_hash_u32(flow_key);
+
+            // Map the hash onto [0, ports) with a multiply+shift (Lemire's
+            // fastrange); same unbiased bucket pick as %, without the divide.
+            size_t port_index = (size_t)(((uint64_t)hash_code * (uint64_t)available_offered_port_num) >> 32);
+
+            LOG_DEBUG("VID can't be found in accepted port table, push up to next spine\n");
+            LOG_DEBUG("available_offered_port_num = %lu\n",available_offered_port_num);
+            LOG_DEBUG("Hash ascii value array = {%d,%d,%d,%d}, hash_code = %u\n", hash_str[0], hash_str[1], hash_str[2], hash_str[3],hash_code);
+            LOG_DEBUG("Mod pos index = %lu\n",port_index);
+            route_ports[port_index]->last_sent_time = get_milli_sec();
+            // LOG_DEBUG("Sent data message at time = %lld, update port sent time\n",t);
+            route_data_from_spine(route_ports[port_index]->port_name,recvBuffer_MTP + 14,recv_len_MTP - 14);
         }
     }
 }
 
-void handle_receive_keep_alive(char* recvOnEtherPort){
+void handle_receive_keep_alive(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP){
+    struct control_port* cp_temp;
+    struct VID_accepted_port* vap_temp;
         // update receive time of receive keep alive message
-    if((cp_temp = find_control_port_by_name(cp_head,recvOnEtherPort))){ // find the receive port
+    if((cp_temp = cp_lookup(recvOnEtherPort))){ // find the receive port
 
         if(cp_temp->fail_type == DETECT_FAIL) return;
         else if(cp_temp->fail_type == MISS_FAIL) cp_temp->fail_type = 0;
 
-        long long current_timestamp = get_milli_sec(&current_time); // get current time stamp
+        long long current_timestamp = get_milli_sec(); // get current time stamp
 
-        // log_message("Received keep alive at time %lld, update port %s\n",current_timestamp,cp_temp->port_name);
+        // LOG_DEBUG("Received keep alive at time %lld, update port %s\n",current_timestamp,cp_temp->port_name);
         
         // recover code
         if(!cp_temp->isUP && current_timestamp - cp_temp->last_received_time < DEAD_TIMER && cp_temp->continue_count < 3){
             cp_temp->continue_count++;
-            log_message("Received from port %s at time %lld\n",recvOnEtherPort,current_timestamp);
-            log_message("%s -> count =  %d\n",cp_temp->port_name,cp_temp->continue_count);
+            LOG_DEBUG("Received from port %s at time %lld\n",recvOnEtherPort,current_timestamp);
+            LOG_DEBUG("%s -> count =  %d\n",cp_temp->port_name,cp_temp->continue_count);
             if(cp_temp->continue_count == 3){ // received three consecutive on time keep alive, turn on this port again
                 uint16_t numOfVID = 0;
-                log_message("--------Turn on for port %s after received 3 KEEP ALIVE message --------\n",cp_temp->port_name);
+                LOG_DEBUG("--------Turn on for port %s after received 3 KEEP ALIVE message --------\n",cp_temp->port_name);
                 
                 //recover code here
                 if((vap_temp = find_accepted_port_by_name(vap_head,cp_temp->port_name))){ // downstream port recovered
                     if(is_all_offered_ports_down(vop_head) && !mtpConfig.isTopSpine){
                         cp_temp->isUP = 1;
-                        numOfVID = get_all_accepted_VIDs(vap_head, temp_2d_array);
+                        topology_gen++;
+                        numOfVID = get_all_accepted_VIDs(vap_head, temp_vid_values);
+                        size_t fanout = 0;
                         for(vap_temp = vap_head;vap_temp;vap_temp = vap_temp->next){
                             if(vap_temp->cp->isUP){
-                                send_failure_update(vap_temp->port_name, temp_2d_array,numOfVID, REACHABLE_OPTION);
+                                fanout = fanout_add(fanout, vap_temp->cp);
                             }
                         }
+                        send_failure_update_batch(fanout_ports, fanout, temp_vid_values, numOfVID, REACHABLE_OPTION);
                     }else{
 
-                        numOfVID = get_accepted_VIDs_by_port_name(vap_head, cp_temp->port_name, temp_2d_array);
-                        for(struct control_port* cp_temp2 = cp_head;cp_temp2;cp_temp2 = cp_temp2->next){
-                            if(cp_temp2->isUP){ 
-                                // send
-                                log_message("Sent recover at time %lld\n",get_milli_sec(&current_time));
-                                send_recover_update(cp_temp2->port_name,temp_2d_array,numOfVID,UNREACHABLE_OPTION);
+                        numOfVID = get_accepted_VIDs_by_port_name(vap_head, cp_temp->port_name, temp_vid_values);
+                        size_t fanout = 0;
+                        for(size_t i = 0;i < cp_array_len;i++){
+                            if(cp_array[i]->isUP){ 
+                                fanout = fanout_add(fanout, cp_array[i]);
                             }else{ // store 
-                                // prn_head = add_to_port_recover_notification_table(prn_head, cp_temp2->port_name, copy_VID_table(vap_temp->VID_head), UNREACHABLE_OPTION);
+                                // prn_head = add_to_port_recover_notification_table(prn_head, cp_array[i]->port_name, copy_VID_table(vap_temp->VID_head), UNREACHABLE_OPTION);
                             }
-                        } 
+                        }
+                        LOG_DEBUG("Sent recover at time %lld\n",current_timestamp);
+                        send_recover_update_batch(fanout_ports, fanout, temp_vid_values, numOfVID, UNREACHABLE_OPTION);
                         
                         cp_temp->isUP = 1;
+                        topology_gen++;
                     }
                 }else{
                     if(is_all_offered_ports_down(vop_head) && !mtpConfig.isLeaf){
                         cp_temp->isUP = 1;
+                        topology_gen++;
+                        size_t recover_fanout = 0;
                         for(vap_temp = vap_head;vap_temp;vap_temp = vap_temp->next){
                             if(vap_temp->cp->isUP){
-                                send_recover_update(vap_temp->port_name,NULL,0,REACHABLE_OPTION);
+                                recover_fanout = fanout_add(recover_fanout, vap_temp->cp);
                             }else{
                                 // prn_head = add_to_port_recover_notification_table(prn_head, vap_temp->port_name, NULL, REACHABLE_OPTION);
                             }
                         }
+                        send_recover_update_batch(fanout_ports, recover_fanout, NULL, 0, REACHABLE_OPTION);
                     }
                     cp_temp->isUP = 1;
+                    topology_gen++;
                 }
             }
         }
@@ -753,101 +1057,126 @@ void handle_receive_keep_alive(char* recvOnEtherPort){
 }
 
 void handle_receive_failure_update(unsigned char* recvBuffer_MTP,char* recvOnEtherPort,  socklen_t recv_len_MTP){
-    log_message("\n FAILURE UPDATE message received at %lld, on port %s \n",get_milli_sec(&current_time), recvOnEtherPort);
+    long long now_ms = get_milli_sec_precise(); // One sample per message; reused by every timestamped line below.
+    log_message("\n FAILURE UPDATE message received at %lld, on port %s \n",now_ms, recvOnEtherPort);
     log_message("Message size = %d\n",recv_len_MTP);
 
     uint8_t table_option = recvBuffer_MTP[15];
-    log_message("Extract option = %d\n",table_option);
-    uint16_t numOfVID = extract_VID_from_receive_buff(temp_2d_array,recvBuffer_MTP + 16,1);
+    LOG_DEBUG("Extract option = %d\n",table_option);
+    uint16_t numOfVID = extract_VID_values_from_receive_buff(NULL,temp_vid_values,recvBuffer_MTP + 16);
+
+    // Resolve the arrival port once; the transfer loop below skips it by
+    // pointer identity instead of a strcmp per peer.
+    struct control_port* sender_cp = cp_lookup(recvOnEtherPort);
+    struct VID_accepted_port* vap_temp;
+    struct VID_offered_port* vop_temp;
 
     if((vap_temp = find_accepted_port_by_name(vap_head,recvOnEtherPort))){
-        log_message("Received from downstream\n");
+        LOG_DEBUG("Received from downstream\n");
         for(uint16_t k = 0;k < numOfVID;k++){
-            log_message("Adding VID = %s to unreachable table for port %s\n",temp_2d_array[k],recvOnEtherPort);
-            vap_temp->ut = add_to_unreachable_table(vap_temp->ut,temp_2d_array[k]);
+            LOG_DEBUG("Adding VID = %u to unreachable table for port %s\n",temp_vid_values[k],recvOnEtherPort);
+            vid_set_add_value(&vap_temp->ut->vids,temp_vid_values[k]);
+        }
+        // Dumping the table walks every member; skip it entirely below debug
+        // verbosity rather than paying the traversal just to drop the lines.
+        if(__builtin_expect(log_level >= MTP_LOG_DEBUG, 0)){
+            print_unreachable_table(vap_temp->ut);
         }
-        print_unreachable_table(vap_temp->ut);
 
-        log_message("Transfer this message from other working ports\n");
+        LOG_DEBUG("Transfer this message from other working ports\n");
 
-        for(cp_temp = cp_head;cp_temp;cp_temp = cp_temp->next){
-            if(strcmp(cp_temp->port_name, recvOnEtherPort) && cp_temp->isUP){
-                send_failure_update(cp_temp->port_name,temp_2d_array, numOfVID, UNREACHABLE_OPTION);
+        size_t fanout = 0;
+        for(size_t i = 0;i < cp_array_len;i++){
+            if(cp_array[i] != sender_cp && cp_array[i]->isUP){
+                fanout = fanout_add(fanout, cp_array[i]);
             }
         }
+        send_failure_update_batch(fanout_ports, fanout, temp_vid_values, numOfVID, UNREACHABLE_OPTION);
     }else if((vop_temp = find_offered_port_by_name(vop_head,recvOnEtherPort))){
-        log_message("Received from upstream\n");
+        LOG_DEBUG("Received from upstream\n");
         if(table_option == UNREACHABLE_OPTION){
-            log_message("Updated unreachable table for port %s\n",recvOnEtherPort);
-            vop_temp->rt->VID_head = clear_VID_table(vop_temp->rt->VID_head); // clear reachable table 
+            LOG_DEBUG("Updated unreachable table for port %s\n",recvOnEtherPort);
+            vid_set_clear(&vop_temp->rt->vids); // clear reachable table 
             for(uint16_t k = 0;k < numOfVID;k++){
-                log_message("Adding VID %s to unreachable table\n",temp_2d_array[k]);
-                vop_temp->ut = add_to_unreachable_table(vop_temp->ut,temp_2d_array[k]);
+                LOG_DEBUG("Adding VID %u to unreachable table\n",temp_vid_values[k]);
+                vid_set_add_value(&vop_temp->ut->vids,temp_vid_values[k]);
             }
         }else{
-            log_message("Updated reachable table for port %s\n",recvOnEtherPort);
-            // vop_temp->ut->VID_head = clear_VID_table(vop_temp->ut->VID_head); // clear unreachable table
-            vop_temp->rt->VID_head = clear_VID_table(vop_temp->rt->VID_head); // clear reachable table
+            LOG_DEBUG("Updated reachable table for port %s\n",recvOnEtherPort);
+            // vid_set_clear(&vop_temp->ut->vids); // clear unreachable table
+            vid_set_clear(&vop_temp->rt->vids); // clear reachable table
             for(uint16_t k = 0;k < numOfVID;k++){
-                log_message("Adding VID %s to reachable table\n",temp_2d_array[k]);
-                vop_temp->rt = add_to_reachable_table(vop_temp->rt,temp_2d_array[k]);
+                LOG_DEBUG("Adding VID %u to reachable table\n",temp_vid_values[k]);
+                vid_set_add_value(&vop_temp->rt->vids,temp_vid_values[k]);
             }
             
         }
 
         if(mtpConfig.isLeaf){
-            log_message("I am a tor, do nothing\n");
-            log_message("Finished processing failure message at time = %lld\n",get_milli_sec(&current_time));
+            LOG_DEBUG("I am a tor, do nothing\n");
+            LOG_DEBUG("Finished processing failure message at time = %lld\n",get_milli_sec());
             return;
         }
 
         if(!is_unreachable_and_reachable_empty(vop_head)){
-            log_message("All offered ports are not clean, keep sending\n");
-            if((numOfVID = get_unreachable_VIDs_from_offered_ports(vop_head, temp_2d_array))){
+            LOG_DEBUG("All offered ports are not clean, keep sending\n");
+            if((numOfVID = get_unreachable_VIDs_from_offered_ports(vop_head, temp_vid_values))){
+                size_t fanout = 0;
                 for(vap_temp = vap_head;vap_temp;vap_temp = vap_temp->next){ // send black first
                     if(vap_temp->cp->isUP){
-                        send_failure_update(vap_temp->port_name, temp_2d_array, numOfVID, UNREACHABLE_OPTION);
+                        fanout = fanout_add(fanout, vap_temp->cp);
                     }
                 }
+                send_failure_update_batch(fanout_ports, fanout, temp_vid_values, numOfVID, UNREACHABLE_OPTION);
             }
         }else{
-            log_message("Some upstream ports are clean, DONE\n");
+            LOG_DEBUG("Some upstream ports are clean, DONE\n");
         }
     }
-    log_message("Finished processing failure message at time = %lld\n",get_milli_sec(&current_time));
+    LOG_DEBUG("Finished processing failure message at time = %lld\n",get_milli_sec());
 }
 
-void handle_receive_recover_update(unsigned char* recvBuffer_MTP,char* recvOnEtherPort){
-    log_message("\n RECOVER UPDATE message received at %lld, on port %s \n",get_milli_sec(&current_time), recvOnEtherPort);
+void handle_receive_recover_update(unsigned char* recvBuffer_MTP,char* recvOnEtherPort, socklen_t recv_len_MTP){
+    long long now_ms = get_milli_sec_precise(); // One sample per message, as in the failure handler.
+    LOG_DEBUG("\n RECOVER UPDATE message received at %lld, on port %s \n",now_ms, recvOnEtherPort);
     uint8_t table_option = recvBuffer_MTP[15];
-    log_message("Extract option = %d\n",table_option);
-    uint16_t numOfVID = extract_VID_from_receive_buff(temp_2d_array,recvBuffer_MTP + 16,1);
+    LOG_DEBUG("Extract option = %d\n",table_option);
+    uint16_t numOfVID = extract_VID_values_from_receive_buff(NULL,temp_vid_values,recvBuffer_MTP + 16);
+
+    // Same sender-skip trick as the failure handler: one lookup, pointer
+    // compares in the loop.
+    struct control_port* sender_cp = cp_lookup(recvOnEtherPort);
+    struct VID_accepted_port* vap_temp;
+    struct VID_offered_port* vop_temp;
 
     if((vap_temp = find_accepted_port_by_name(vap_head,recvOnEtherPort))){
-        log_message("Received from downstream\n");
+        LOG_DEBUG("Received from downstream\n");
         for(uint16_t k = 0;k < numOfVID;k++){
-            log_message("Removing VID = %s unreachable table for port %s\n",temp_2d_array[k],recvOnEtherPort);
-            vap_temp->ut = remove_unreachable_VID_by_name(vap_temp->ut,temp_2d_array[k]);
+            LOG_DEBUG("Removing VID = %u unreachable table for port %s\n",temp_vid_values[k],recvOnEtherPort);
+            vid_set_remove_value(&vap_temp->ut->vids,temp_vid_values[k]);
         }
 
-        print_unreachable_table(vap_temp->ut);
+        if(__builtin_expect(log_level >= MTP_LOG_DEBUG, 0)){
+            print_unreachable_table(vap_temp->ut);
+        }
 
-        log_message("Transfer this message from other working ports\n");
+        LOG_DEBUG("Transfer this message from other working ports\n");
 
-        for(cp_temp = cp_head;cp_temp;cp_temp = cp_temp->next){
-            if(strcmp(cp_temp->port_name, recvOnEtherPort) && cp_temp->isUP){
-                send_recover_update(cp_temp->port_name,temp_2d_array, numOfVID, UNREACHABLE_OPTION);
-                log_message("Sent out from port %s\n",cp_temp->port_name);
+        size_t fanout = 0;
+        for(size_t i = 0;i < cp_array_len;i++){
+            if(cp_array[i] != sender_cp && cp_array[i]->isUP){
+                fanout = fanout_add(fanout, cp_array[i]);
             }
         }
+        send_recover_update_batch(fanout_ports, fanout, temp_vid_values, numOfVID, UNREACHABLE_OPTION);
     }else if((vop_temp = find_offered_port_by_name(vop_head,recvOnEtherPort))){
-        log_message("Received from upstream\n");
+        LOG_DEBUG("Received from upstream\n");
         
         if(table_option == UNREACHABLE_OPTION){
             int is_clean_before = is_unreachable_and_reachable_empty(vop_head);
             for(uint16_t k = 0;k < numOfVID;k++){
-                log_message("Removing VID = %s from unreachable table for port %s\n",temp_2d_array[k],recvOnEtherPort);
-                vop_temp->ut = remove_unreachable_VID_by_name(vop_temp->ut,temp_2d_array[k]);
+                LOG_DEBUG("Removing VID = %u from unreachable table for port %s\n",temp_vid_values[k],recvOnEtherPort);
+                vid_set_remove_value(&vop_temp->ut->vids,temp_vid_values[k]);
             }
             int is_clean_after = is_unreachable_and_reachable_empty(vop_head);
 
@@ -856,36 +1185,42 @@ void handle_receive_recover_update(unsigned char* recvBuffer_MTP,char* recvOnEth
             }
 
             if(!is_clean_before && !is_clean_after){
+                size_t fanout = 0;
                 for(vap_temp = vap_head;vap_temp;vap_temp = vap_temp->next){
                     if(vap_temp->cp->isUP){
-                        send_recover_update(vap_temp->port_name, temp_2d_array, numOfVID, UNREACHABLE_OPTION);
+                        fanout = fanout_add(fanout, vap_temp->cp);
                     }
                 }
+                send_recover_update_batch(fanout_ports, fanout, temp_vid_values, numOfVID, UNREACHABLE_OPTION);
             }else if(!is_clean_before && is_clean_after){
-                numOfVID += get_unreachable_VIDs_from_offered_ports(vop_head, temp_2d_array + numOfVID);
+                numOfVID += get_unreachable_VIDs_from_offered_ports(vop_head, temp_vid_values + numOfVID);
+                size_t fanout = 0;
                 for(vap_temp = vap_head;vap_temp;vap_temp = vap_temp->next){ // send black first
                     if(vap_temp->cp->isUP){
-                        send_recover_update(vap_temp->port_name, temp_2d_array, numOfVID, UNREACHABLE_OPTION);
+                        fanout = fanout_add(fanout, vap_temp->cp);
                     }
                 }
+                send_recover_update_batch(fanout_ports, fanout, temp_vid_values, numOfVID, UNREACHABLE_OPTION);
             }
 
         }else{
-            log_message("Clear reachable table for port %s\n",recvOnEtherPort);
+            LOG_DEBUG("Clear reachable table for port %s\n",recvOnEtherPort);
             int is_clean_before = is_unreachable_and_reachable_empty(vop_head);
-            vop_temp->rt->VID_head = clear_VID_table(vop_temp->rt->VID_head); // clear reachable table   
+            vid_set_clear(&vop_temp->rt->vids); // clear reachable table   
             
             if(mtpConfig.isLeaf){
                 return;
             }
             int is_clean_after = is_unreachable_and_reachable_empty(vop_head);
             if(!is_clean_before && is_clean_after){
-                if((numOfVID = get_unreachable_VIDs_from_offered_ports(vop_head, temp_2d_array))){
+                if((numOfVID = get_unreachable_VIDs_from_offered_ports(vop_head, temp_vid_values))){
+                    size_t fanout = 0;
                     for(vap_temp = vap_head;vap_temp;vap_temp = vap_temp->next){ // send black first
                         if(vap_temp->cp->isUP){
-                            send_recover_update(vap_temp->port_name, temp_2d_array, numOfVID, UNREACHABLE_OPTION);
+                            fanout = fanout_add(fanout, vap_temp->cp);
                         }
                     }
+                    send_recover_update_batch(fanout_ports, fanout, temp_vid_values, numOfVID, UNREACHABLE_OPTION);
                 }
             }          
         }
@@ -893,43 +1228,49 @@ void handle_receive_recover_update(unsigned char* recvBuffer_MTP,char* recvOnEth
 }
 
 void handle_receive_from_server(unsigned char* recvBuffer_IP,char* recvOnEtherPort, socklen_t recv_len_IP){
-    log_message("\n Received an IP message on port %s from server\n",  recvOnEtherPort); 
+    LOG_DEBUG("\n Received an IP message on port %s from server\n",  recvOnEtherPort); 
     unsigned char *ip_header_with_payload = recvBuffer_IP + 14;
 
-    log_message("Src IP = %d.%d.%d.%d\n",ip_header_with_payload[12],ip_header_with_payload[13],ip_header_with_payload[14],ip_header_with_payload[15]);
-    log_message("Dest IP = %d.%d.%d.%d\n",ip_header_with_payload[16],ip_header_with_payload[17],ip_header_with_payload[18],ip_header_with_payload[19]);
-
-    uint16_t src_VID = ip_header_with_payload[12 + VID_octet - 1];
-    uint16_t dest_VID = ip_header_with_payload[16 + VID_octet - 1];
-    uint8_t src_ip_3 = ip_header_with_payload[14]; // third byte of src IP
-    uint8_t src_ip_4 = ip_header_with_payload[15]; // fourth byte of src IP
-    uint8_t dest_ip_3 = ip_header_with_payload[18]; // third byte of dest IP
-    uint8_t dest_ip_4 = ip_header_with_payload[19]; // fourth byte of dest IP
-
-    char dest_VID_str[VID_LEN];
-    int_to_str(dest_VID_str, dest_VID);
-
-    log_message("Src VID = %d\n",src_VID);
-    log_message("Dest VID = %d\n",dest_VID);
-
-    // hash implementation
-    char hash_str[32]; 
-    hash_str[0] = src_ip_3;
-    hash_str[1] = src_ip_4;
-    hash_str[2] = dest_ip_3;
-    hash_str[3] = dest_ip_4;
-
-    uint32_t hash_code = jenkins_one_at_a_time_hash(hash_str,4); // hash src VID and dest VID
-    size_t available_offered_port_num = count_available_offered_port(vop_head,temp_2d_array,dest_VID_str);
-    if(!available_offered_port_num){
-        log_message("Found 0 available port, packet dumped\n");
+    LOG_DEBUG("Src IP = %d.%d.%d.%d\n",ip_header_with_payload[12],ip_header_with_payload[13],ip_header_with_payload[14],ip_header_with_payload[15]);
+    LOG_DEBUG("Dest IP = %d.%d.%d.%d\n",ip_header_with_payload[16],ip_header_with_payload[17],ip_header_with_payload[18],ip_header_with_payload[19]);
+
+    /*
+        All four fields of interest live in bytes 12..19 of the IP header, so
+        two unaligned word loads (the memcpys fold to plain movs) replace
+        eight dependent byte reads; the VIDs and the flow key are then just
+        shifts and masks on registers.
+    */
+    uint32_t src_ip;
+    uint32_t dest_ip;
+    memcpy(&src_ip, ip_header_with_payload + 12, 4);
+    memcpy(&dest_ip, ip_header_with_payload + 16, 4);
+
+    uint16_t src_VID = (src_ip >> ((VID_octet - 1) * 8)) & 0xff;
+    uint16_t dest_VID = (dest_ip >> ((VID_octet - 1) * 8)) & 0xff;
+
+    LOG_DEBUG("Src VID = %d\n",src_VID);
+    LOG_DEBUG("Dest VID = %d\n",dest_VID);
+
+    // Flow key = {src3, src4, dest3, dest4}, assembled from the two words —
+    // the same bytes the old hash_str array carried. Same crc32-backed flow
+    // hash as the spine data path; Jenkins remains the fallback inside
+    // flow_hash_u32 for parts without SSE4.2.
+    uint32_t flow_key = (src_ip >> 16) | (dest_ip & 0xffff0000u);
+    uint32_t hash_code = flow_hash_u32(flow_key);
+    struct control_port** route_ports;
+    size_t available_offered_port_num = lookup_available_ports(dest_VID,&route_ports);
+    if(__builtin_expect(!available_offered_port_num, 0)){ // Only during failures.
+        LOG_DEBUG("Found 0 available port, packet dumped\n");
     }else{
-        log_message("available_port_num = %lu\n",available_offered_port_num);
-        log_message("Hash ascii value array = {%d,%d,%d,%d}, hash_code = %u\n", hash_str[0], hash_str[1], hash_str[2], hash_str[3],hash_code);
-        log_message("Mod pos index = %lu\n",hash_code % available_offered_port_num);
+        // Fastrange bucket pick, as in the spine data path.
+        size_t port_index = (size_t)(((uint64_t)hash_code * (uint64_t)available_offered_port_num) >> 32);
+
+        LOG_DEBUG("available_port_num = %lu\n",available_offered_port_num);
+        LOG_DEBUG("Hash ascii value array = {%d,%d,%d,%d}, hash_code = %u\n", flow_key & 0xff, (flow_key >> 8) & 0xff, (flow_key >> 16) & 0xff, flow_key >> 24,hash_code);
+        LOG_DEBUG("Mod pos index = %lu\n",port_index);
         // pick one port, then send the message out
 
-        find_control_port_by_name(cp_head,temp_2d_array[hash_code % available_offered_port_num])->last_sent_time = get_milli_sec(&current_time);
-        route_data_from_tor_to_spine(temp_2d_array[hash_code % available_offered_port_num], src_VID, dest_VID, ip_header_with_payload, recv_len_IP - 14); 
+        route_ports[port_index]->last_sent_time = get_milli_sec();
+        route_data_from_tor_to_spine(route_ports[port_index]->port_name, src_VID, dest_VID, ip_header_with_payload, recv_len_IP - 14);
     }
 }
\ No newline at end of file
@@ -8,6 +8,30 @@ unsigned char payload[MAX_BUFFER_SIZE];
  * -----------------------------------------------------------------------------------------
  */ 
 
+/*
+    Serialize integer VIDs as the length-prefixed decimal strings the wire
+    format carries; digits are rendered straight into the payload so the
+    update pipeline never materializes VID strings in memory.
+*/
+size_t build_VID_value_payload(unsigned char *payload, const uint16_t* VID_array, uint16_t VID_array_size){
+    size_t size_count = 0;
+    for(uint16_t i = 0; i < VID_array_size;i++){
+        char digits[5];
+        uint16_t value = VID_array[i];
+        uint8_t vid_len = 0;
+        do{
+            digits[vid_len++] = (char)('0' + value % 10);
+            value /= 10;
+        }while(value);
+
+        payload[size_count++] = vid_len;
+        while(vid_len){
+            payload[size_count++] = (unsigned char)digits[--vid_len];
+        }
+    }
+    return size_count;
+}
+
 size_t build_VID_data_payload(unsigned char *payload, char** VID_array, uint16_t VID_array_size){
     size_t size_count = 0;
     for(uint16_t i = 0; i < VID_array_size;i++){
@@ -146,29 +170,44 @@ int send_keep_alive(char *current_port_name)
 }
 
 
-int send_failure_update(char *current_port_name, char **VID_array, uint16_t VID_array_size, uint8_t update_option){
-    log_message("Sending failure update message out from port %s\n",current_port_name);
+/*
+ * Fan a single failure update out to a set of working ports. The payload is
+ * identical for every port, so it is serialized once and the batch goes out
+ * through one sendmmsg() instead of a sendto() per port.
+ */
+int send_failure_update_batch(struct control_port **ports, size_t port_count, const uint16_t *VID_array, uint16_t VID_array_size, uint8_t update_option){
+    if(port_count == 0) return 0;
+
+    for(size_t k = 0; k < port_count; k++){
+        log_message("Sending failure update message out from port %s\n",ports[k]->port_name);
+    }
 
     payload[0] = MTP_TYPE_FAILURE_UPDATE;
     payload[1] = update_option;
     memcpy(payload + 2,&VID_array_size,2);
-    int payload_len = 4 + build_VID_data_payload(payload + 4, VID_array, VID_array_size);
+    int payload_len = 4 + build_VID_value_payload(payload + 4, VID_array, VID_array_size);
 
-    if(payload_len){
-        dataSend(current_port_name, payload_len, payload);
-    }
+    return batchSend(ports, port_count, payload_len, payload);
 }
 
-int send_recover_update(char *current_port_name, char** VID_array, uint16_t VID_array_size, uint8_t update_option){
-    log_message("Sending recover update message out from port %s\n",current_port_name);
+/*
+ * Recover-side counterpart of send_failure_update_batch: the payload is
+ * identical for every port, so it is serialized once and the batch goes out
+ * through one sendmmsg().
+ */
+int send_recover_update_batch(struct control_port **ports, size_t port_count, const uint16_t *VID_array, uint16_t VID_array_size, uint8_t update_option){
+    if(port_count == 0) return 0;
+
+    for(size_t k = 0; k < port_count; k++){
+        log_message("Sending recover update message out from port %s\n",ports[k]->port_name);
+    }
+
     payload[0] = MTP_TYPE_RECOVER_UPDATE;
     payload[1] = update_option;
     memcpy(payload + 2,&VID_array_size,2);
-    int payload_len = 4 + build_VID_data_payload(payload + 4, VID_array, VID_array_size);
-    
-    if(payload_len){
-        dataSend(current_port_name, payload_len, payload);
-    }
+    int payload_len = 4 + build_VID_value_payload(payload + 4, VID_array, VID_array_size);
+
+    return batchSend(ports, port_count, payload_len, payload);
 }
 
 
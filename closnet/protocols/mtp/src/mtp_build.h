@@ -46,9 +46,9 @@ void route_data_to_server(char *current_port_name,unsigned char *payload, unsign
 
 int send_keep_alive(char *current_port_name);
 
-int send_failure_update(char *current_port_name, char** VID_array, uint16_t VID_array_size, uint8_t update_option);
+int send_failure_update_batch(struct control_port **ports, size_t port_count, const uint16_t* VID_array, uint16_t VID_array_size, uint8_t update_option);
 
-int send_recover_update(char *current_port_name, char** VID_array, uint16_t VID_array_size, uint8_t update_option);
+int send_recover_update_batch(struct control_port **ports, size_t port_count, const uint16_t* VID_array, uint16_t VID_array_size, uint8_t update_option);
 
 
 size_t build_VID_data_payload(unsigned char *payload, char** VID_array, uint16_t VID_array_size);
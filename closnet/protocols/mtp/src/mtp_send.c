@@ -1,3 +1,5 @@
+#define _GNU_SOURCE // sendmmsg()
+
 #include "mtp_send.h"
 
 int socketfd = -1;
@@ -10,24 +12,28 @@ struct control_port* t;
 extern compute_interface *compute_intf_head;
 compute_interface *computeFrame;
 
-int dataSend(char* port_name, int payloadLen, unsigned char *inPayload) 
+int dataSend(char* port_name, int payloadLen, unsigned char *inPayload)
 {
-	t = find_control_port_by_name(cp_head, port_name);
-
-	//HEADER_SIZE = 14, as defined by mtp_send.h | payloadLen is 1 at this point (?)
-	int frame_size = HEADER_SIZE + payloadLen;
-
-	// Copying payLoad to frame
-	//log_message("\n\n BEFORE copying payload in ctrlSend\n");
-	memcpy(t->frame + HEADER_SIZE, inPayload, payloadLen);
-
+	t = cp_lookup(port_name);
 
 	/* Send frame
-	 * sockfd is the socket being utilized, frame is the message being sent, frame_size is the length of the message
-	 * &socket_address is the destination address being used (has to be of struct sockaddr)
-	 *
+	 * The port's prebuilt Ethernet header and the payload go to the kernel as
+	 * two iovecs, so the payload is never copied into the frame buffer first —
+	 * the only copy left is the kernel's own into the skb.
 	 */
-	if (sendto(socketfd, t->frame, frame_size, MSG_NOSIGNAL, (struct sockaddr*) t->socket_address, sizeof(struct sockaddr_ll)) < 0) {
+	struct iovec iov[2] = {
+		{ .iov_base = t->frame, .iov_len = HEADER_SIZE },
+		{ .iov_base = inPayload, .iov_len = payloadLen }
+	};
+
+	struct msghdr msg = {
+		.msg_name = t->socket_address,
+		.msg_namelen = sizeof(struct sockaddr_ll),
+		.msg_iov = iov,
+		.msg_iovlen = 2
+	};
+
+	if (sendmsg(socketfd, &msg, MSG_NOSIGNAL) < 0) {
 		perror("Send error (datasend)");
 		return -1;
 	}
@@ -35,18 +41,73 @@ int dataSend(char* port_name, int payloadLen, unsigned char *inPayload)
 	return 0;
 }
 
-int computeSend(char* port_name, int payloadLen, unsigned char *inPayload) 
+/*
+ * Send one shared payload out of several control ports with a single
+ * sendmmsg() call. Each message leads with the port's own prebuilt Ethernet
+ * header and then points a second iovec at the common payload, so the payload
+ * is neither re-serialized nor copied per port and the whole fan-out costs
+ * one syscall.
+ */
+int batchSend(struct control_port **ports, size_t port_count, int payloadLen, unsigned char *inPayload)
+{
+	static struct mmsghdr msgs[MAX_PORTS];
+	static struct iovec iov[MAX_PORTS][2];
+
+	for(size_t k = 0; k < port_count; k++)
+	{
+		iov[k][0].iov_base = ports[k]->frame;
+		iov[k][0].iov_len = HEADER_SIZE;
+		iov[k][1].iov_base = inPayload;
+		iov[k][1].iov_len = payloadLen;
+
+		memset(&msgs[k].msg_hdr, 0, sizeof(struct msghdr));
+		msgs[k].msg_hdr.msg_iov = iov[k];
+		msgs[k].msg_hdr.msg_iovlen = 2;
+		msgs[k].msg_hdr.msg_name = ports[k]->socket_address;
+		msgs[k].msg_hdr.msg_namelen = sizeof(struct sockaddr_ll);
+	}
+
+	// sendmmsg() may stop short when a later message errors; resume from the
+	// partial count so one bad port does not starve the remaining updates.
+	// A failing message is reported and skipped, matching the old behavior
+	// of attempting every port independently.
+	size_t sent = 0;
+	int result = 0;
+	while(sent < port_count)
+	{
+		int batch = sendmmsg(socketfd, msgs + sent, port_count - sent, MSG_NOSIGNAL);
+		if(batch < 0)
+		{
+			perror("Send error (batchSend)");
+			result = -1;
+			sent++;
+			continue;
+		}
+		sent += batch;
+	}
+
+	return result;
+}
+
+int computeSend(char* port_name, int payloadLen, unsigned char *inPayload)
 {
 	computeFrame = compute_intf_head;
 
-	//HEADER_SIZE = 14, as defined by mtp_send.h | payloadLen is 1 at this point (?)
-	int frame_size = HEADER_SIZE + payloadLen;
+	// Same scatter-gather shape as dataSend: cached header plus payload,
+	// no staging copy into the frame buffer.
+	struct iovec iov[2] = {
+		{ .iov_base = computeFrame->frame, .iov_len = HEADER_SIZE },
+		{ .iov_base = inPayload, .iov_len = payloadLen }
+	};
 
-	// Copying payLoad to frame
-	//log_message("\n\n BEFORE copying payload in ctrlSend\n");
-	memcpy(computeFrame->frame + HEADER_SIZE, inPayload, payloadLen);
+	struct msghdr msg = {
+		.msg_name = computeFrame->socket_address,
+		.msg_namelen = sizeof(struct sockaddr_ll),
+		.msg_iov = iov,
+		.msg_iovlen = 2
+	};
 
-	if(sendto(socketfd, computeFrame->frame, frame_size, MSG_NOSIGNAL, (struct sockaddr*) computeFrame->socket_address, sizeof(struct sockaddr_ll)) < 0) 
+	if(sendmsg(socketfd, &msg, MSG_NOSIGNAL) < 0)
 	{
 		perror("Send error (computeSend)");
 		return -1;
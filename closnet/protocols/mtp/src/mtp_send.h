@@ -34,6 +34,7 @@
 
 /* Function Prototypes */
 int dataSend(char*, int, unsigned char *);
-int computeSend(char* port_name, int payloadLen, unsigned char *inPayload);                          
+int batchSend(struct control_port **ports, size_t port_count, int payloadLen, unsigned char *inPayload);
+int computeSend(char* port_name, int payloadLen, unsigned char *inPayload);
 
 #endif
@@ -2,10 +2,42 @@
 #include "mtp_struct.h"
 #include "logger.h"
 
+// ============================================ arena allocator ============================================ //
+void arena_init(arena_t* arena, size_t size){
+    arena->base = (char*) malloc(size);
+    if(arena->base == NULL){
+        fprintf(stderr, "Memory allocation failed (arena)\n");
+        exit(EXIT_FAILURE);
+    }
+    arena->cur = arena->base;
+    arena->end = arena->base + size;
+}
+
+void* arena_alloc(arena_t* arena, size_t size){
+    // Keep every node aligned for its pointer members.
+    size = (size + 15u) & ~(size_t)15u;
+
+    // Grab a fresh block when the current one is exhausted. Nodes already
+    // handed out keep the old block alive for the life of the process.
+    if(arena->cur + size > arena->end){
+        size_t blockSize = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        arena_init(arena, blockSize);
+    }
+
+    void* node = arena->cur;
+    arena->cur += size;
+    return node;
+}
+
+void arena_free(arena_t* arena){
+    free(arena->base);
+    arena->base = arena->cur = arena->end = NULL;
+}
+
 // ============================================ function for control_port ============================================ //
-struct control_port* add_to_control_port_table(struct control_port* cp_head, char* new_port_name){
+struct control_port* add_to_control_port_table(arena_t* arena, struct control_port* cp_head, char* new_port_name){
     if(cp_head == NULL){
-        cp_head = build_control_port(new_port_name);
+        cp_head = build_control_port(arena, new_port_name);
     }else{
         struct control_port* cp_temp = cp_head;
 
@@ -19,13 +51,13 @@ struct control_port* add_to_control_port_table(struct control_port* cp_head, cha
             }
             cp_temp = cp_temp->next;
         }
-        cp_temp->next = build_control_port(new_port_name);
+        cp_temp->next = build_control_port(arena, new_port_name);
     }
     return cp_head;
 }
 
-struct control_port* build_control_port(char* new_port_name){
-    struct control_port* new_node = (struct control_port*) malloc(sizeof(struct control_port));
+struct control_port* build_control_port(arena_t* arena, char* new_port_name){
+    struct control_port* new_node = (struct control_port*) arena_alloc(arena, sizeof(struct control_port));
     strcpy(new_node->port_name, new_port_name);
     new_node->isUP = 0;
     new_node->start = 0;
@@ -35,6 +67,10 @@ struct control_port* build_control_port(char* new_port_name){
     new_node->ntf_head = NULL;
     new_node->next = NULL;
     new_node->continue_count = 3;
+
+    // The TX frame lives out of line so the keep-alive scan never pulls it in.
+    new_node->frame = arena_alloc(arena, MAX_BUFFER_SIZE);
+
     return new_node;
 }
 
@@ -50,17 +86,73 @@ struct control_port* find_control_port_by_name(struct control_port* cp_head, cha
     return NULL;
 }
 
+/*
+    Open-addressed index over the control port table, keyed by port name. The
+    port set is fixed once classifyInterfaces() has run, so the index is built
+    a single time and every per-packet lookup costs one hash plus a short
+    probe instead of an O(ports) list walk with a strcmp per node.
+*/
+static struct control_port* cp_index[CP_INDEX_SIZE];
+
+/*
+    Flat snapshot of the control port list, built once with the index. The
+    broadcast and keep-alive loops iterate this array instead of chasing next
+    pointers, so the per-port state they poll streams through the cache in
+    traversal order.
+*/
+struct control_port* cp_array[MAX_PORTS];
+size_t cp_array_len = 0;
+
+static uint32_t fnv1a_hash(const char* key){
+    uint32_t hash = 2166136261u;
+    while(*key){
+        hash ^= (uint8_t)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void cp_index_build(struct control_port* cp_head){
+    memset(cp_index, 0, sizeof(cp_index));
+    cp_array_len = 0;
+    for(struct control_port* cp_temp = cp_head;cp_temp;cp_temp = cp_temp->next){
+        // The flat snapshot and the index are sized for MAX_PORTS entries;
+        // past that the array would overrun and the probe loops could cycle,
+        // so refuse the topology outright rather than corrupt state.
+        if(cp_array_len >= MAX_PORTS){
+            fprintf(stderr, "Too many control ports (max %d), raise MAX_PORTS\n", MAX_PORTS);
+            exit(EXIT_FAILURE);
+        }
+        uint32_t slot = fnv1a_hash(cp_temp->port_name) & (CP_INDEX_SIZE - 1);
+        while(cp_index[slot]){
+            slot = (slot + 1) & (CP_INDEX_SIZE - 1);
+        }
+        cp_index[slot] = cp_temp;
+        cp_array[cp_array_len++] = cp_temp;
+    }
+}
+
+struct control_port* cp_lookup(const char* port_name){
+    uint32_t slot = fnv1a_hash(port_name) & (CP_INDEX_SIZE - 1);
+    while(cp_index[slot]){
+        if(!strcmp(cp_index[slot]->port_name, port_name)){
+            return cp_index[slot];
+        }
+        slot = (slot + 1) & (CP_INDEX_SIZE - 1);
+    }
+    return NULL;
+}
+
+// Nodes are arena-backed, so removal just unlinks; storage is reclaimed with the arena.
 struct control_port* remove_control_port_by_name(struct control_port* cp_head, char* port_name){
     struct control_port* cp_temp = cp_head;
     if(!strcmp(cp_head->port_name, port_name)){
         cp_head = cp_head->next;
-        free(cp_temp);
     }else{
         while(cp_temp->next){
             if(!strcmp(cp_temp->next->port_name,port_name)){
                 struct control_port* dummy = cp_temp->next;
                 cp_temp->next = dummy->next;
-                free(dummy);
                 break;
             }
             cp_temp = cp_temp->next;
@@ -69,10 +161,9 @@ struct control_port* remove_control_port_by_name(struct control_port* cp_head, c
     return cp_head;
 }
 
+// Nodes are arena-backed; dropping the list is just dropping the head pointer.
 struct control_port* clear_control_port(struct control_port* node){
-    if(node == NULL) return NULL;
-    clear_control_port(node->next);
-    free(node);
+    (void)node;
     return NULL;
 }
 
@@ -95,12 +186,12 @@ void print_control_port_table(struct control_port* cp_head)
 }
 
 // ============================================ function for compute interfaces ============================================ //
-compute_interface* addComputeInteface(compute_interface* ci_head, char* new_port_name)
+compute_interface* addComputeInteface(arena_t* arena, compute_interface* ci_head, char* new_port_name)
 {
     // If there are no compute interfaces added, add it as the first one (head).
     if(ci_head == NULL)
     {
-        ci_head = buildComputeInterface(new_port_name);
+        ci_head = buildComputeInterface(arena, new_port_name);
     }
 
     else
@@ -124,19 +215,22 @@ compute_interface* addComputeInteface(compute_interface* ci_head, char* new_port
             ci_temp = ci_temp->next;
         }
 
-        ci_temp->next = buildComputeInterface(new_port_name);
+        ci_temp->next = buildComputeInterface(arena, new_port_name);
     }
 
     return ci_head;
 }
 
-compute_interface* buildComputeInterface(char* new_port_name)
+compute_interface* buildComputeInterface(arena_t* arena, char* new_port_name)
 {
-    compute_interface *new_node = malloc(sizeof(compute_interface));
+    compute_interface *new_node = arena_alloc(arena, sizeof(compute_interface));
 
     strcpy(new_node->port_name, new_port_name);
     new_node->next = NULL;
 
+    // Out-of-line TX frame, matching the control port layout.
+    new_node->frame = arena_alloc(arena, MAX_BUFFER_SIZE);
+
     return new_node;
 }
 
@@ -153,20 +247,52 @@ void printComputeInterfaces(compute_interface *head)
     }
 }
 
+// Nodes are arena-backed; dropping the list is just dropping the head pointer.
 compute_interface* freeComputeInterfaces(compute_interface *interface)
 {
-    if(interface == NULL)
-    {
-        return NULL;
-    } 
-
-    freeComputeInterfaces(interface->next);
-    free(interface);
-
+    (void)interface;
     return NULL;
 }
 
 // ============================================ function for VID ============================================ //
+/*
+    Fixed pool backing the VID list nodes. Unlike the per-port structures,
+    VID nodes are inserted and removed per received control message, so they
+    are served from a freelist threaded through a static slab instead of
+    paying a malloc/free pair on the packet path. The slab keeps the nodes
+    co-located; the heap is only touched if it ever runs dry.
+*/
+static struct VID vid_pool_slab[VID_POOL_SIZE];
+static struct VID* vid_freelist = NULL;
+static int vid_pool_primed = 0;
+
+static struct VID* vid_pool_alloc(void){
+    if(!vid_pool_primed){
+        for(size_t i = 0;i < VID_POOL_SIZE;i++){
+            vid_pool_slab[i].next = vid_freelist;
+            vid_freelist = &vid_pool_slab[i];
+        }
+        vid_pool_primed = 1;
+    }
+
+    if(vid_freelist == NULL){
+        return (struct VID*)malloc(sizeof(struct VID));
+    }
+
+    struct VID* node = vid_freelist;
+    vid_freelist = node->next;
+    return node;
+}
+
+static void vid_pool_free(struct VID* node){
+    if(node >= vid_pool_slab && node < vid_pool_slab + VID_POOL_SIZE){
+        node->next = vid_freelist;
+        vid_freelist = node;
+    }else{
+        free(node); // overflow node, came from the heap
+    }
+}
+
 struct VID* add_to_VID_table(struct VID* VID_head, char* VID_name){
     if(VID_head == NULL){
         VID_head = build_VID(VID_name);
@@ -189,7 +315,7 @@ struct VID* add_to_VID_table(struct VID* VID_head, char* VID_name){
 
 
 struct VID* build_VID(char* VID_name){
-    struct VID *new_node = (struct VID*)malloc(sizeof(struct VID));
+    struct VID *new_node = vid_pool_alloc();
     strcpy(new_node->VID_name, VID_name);
     new_node->next = NULL;
     return new_node;
@@ -212,13 +338,13 @@ struct VID* remove_VID_by_name(struct VID* VID_head,char* VID_name){
     struct VID* VID_temp = VID_head;
     if(!strcmp(VID_head->VID_name, VID_name)){
         VID_head = VID_head->next;
-        free(VID_temp);
+        vid_pool_free(VID_temp);
     }else{
         while(VID_temp->next){
             if(!strcmp(VID_temp->next->VID_name, VID_name)){
                 struct VID* dummy = VID_temp->next;
                 VID_temp->next = dummy->next;
-                free(dummy);
+                vid_pool_free(dummy);
                 break;
             }
             VID_temp = VID_temp->next;
@@ -230,10 +356,38 @@ struct VID* remove_VID_by_name(struct VID* VID_head,char* VID_name){
 struct VID* clear_VID_table(struct VID* node){
     if(node == NULL) return NULL;
     clear_VID_table(node->next);
-    free(node);
+    vid_pool_free(node);
     return NULL;
 }
 
+// Integer prefix of a stored VID name (digits up to the first dot); UINT16_MAX
+// when the name has no leading digits, which no bitmap or wire path accepts.
+static uint16_t VID_prefix_value(const char* VID_name){
+    uint32_t value = 0;
+    const char* c = VID_name;
+    if(*c < '0' || *c > '9'){
+        return UINT16_MAX;
+    }
+    while(*c >= '0' && *c <= '9'){
+        value = value * 10 + (uint32_t)(*c - '0');
+        c++;
+    }
+    return value >= UINT16_MAX ? UINT16_MAX : (uint16_t)value;
+}
+
+// Value-returning twin of get_all_VIDs for the update pipeline, which carries
+// VIDs as integers end to end and only renders digits at the wire boundary.
+size_t get_all_VID_values(struct VID* VID_head, uint16_t* store_array){
+    struct VID* VID_temp = VID_head;
+    size_t counter = 0;
+    while(VID_temp){
+        store_array[counter] = VID_prefix_value(VID_temp->VID_name);
+        counter++;
+        VID_temp = VID_temp->next;
+    }
+    return counter;
+}
+
 size_t get_all_VIDs(struct VID* VID_head, char** store_array){
     struct VID* VID_temp = VID_head;
     size_t counter = 0;
@@ -279,38 +433,159 @@ void print_VID_table(struct VID* VID_head){
 }
 
 
+// Bumped whenever port liveness or a reachable/unreachable table changes, so
+// per-VID routing caches can tell their snapshot is stale. Starts at 1 so a
+// zero-initialized cache entry can never match.
+unsigned int topology_gen = 1;
+
+
+// ============================================ function for vid_set ============================================ //
+static void print_vid_set(const vid_set* set){
+    for(size_t word_index = 0; word_index < MAX_VID / 64; word_index++){
+        uint64_t word = set->bits[word_index];
+        while(word){
+            log_message("%zu\n", word_index * 64 + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+}
+
+
+// Names that are not a bare integer (a port name, a dotted VID) never map to a
+// bit and therefore never match — the same result the old list lookups gave.
+static int vid_set_parse(const char* VID_name, uint16_t* value){
+    char* end;
+    unsigned long parsed = strtoul(VID_name, &end, 10);
+    if(end == VID_name || *end != '\0' || parsed >= MAX_VID){
+        return 0;
+    }
+    *value = (uint16_t) parsed;
+    return 1;
+}
+
+
+void vid_set_clear(vid_set* set){
+    if(set->count != 0){
+        topology_gen++;
+    }
+    memset(set->bits, 0, sizeof(set->bits));
+    set->count = 0;
+}
+
+
+void vid_set_add_value(vid_set* set, uint16_t value){
+    if(value >= MAX_VID){
+        return;
+    }
+    uint64_t mask = 1ULL << (value & 63);
+    if(!(set->bits[value >> 6] & mask)){ // Duplicates leave the set untouched, like the list did.
+        set->bits[value >> 6] |= mask;
+        set->count++;
+        topology_gen++;
+    }
+}
+
+
+void vid_set_remove_value(vid_set* set, uint16_t value){
+    if(value >= MAX_VID){
+        return;
+    }
+    uint64_t mask = 1ULL << (value & 63);
+    if(set->bits[value >> 6] & mask){
+        set->bits[value >> 6] &= ~mask;
+        set->count--;
+        topology_gen++;
+    }
+}
+
+
+int vid_set_add(vid_set* set, const char* VID_name){
+    uint16_t value;
+    if(!vid_set_parse(VID_name, &value)){
+        return 0;
+    }
+    vid_set_add_value(set, value);
+    return 1;
+}
+
+
+int vid_set_remove(vid_set* set, const char* VID_name){
+    uint16_t value;
+    if(!vid_set_parse(VID_name, &value)){
+        return 0;
+    }
+    vid_set_remove_value(set, value);
+    return 1;
+}
+
+
+int vid_set_contains_value(const vid_set* set, uint16_t value){
+    if(value >= MAX_VID){
+        return 0;
+    }
+    return (set->bits[value >> 6] >> (value & 63)) & 1;
+}
+
+
+int vid_set_contains(const vid_set* set, const char* VID_name){
+    uint16_t value;
+    if(!vid_set_parse(VID_name, &value)){
+        return 0;
+    }
+    return vid_set_contains_value(set, value);
+}
+
+
+// Writes each member out in ascending order and returns the member count;
+// pass NULL to just count. Scans a word at a time, peeling set bits with ctz,
+// so empty regions of the bitmap cost one load each.
+size_t vid_set_decode(const vid_set* set, uint16_t* store_array){
+    size_t counter = 0;
+    for(size_t word_index = 0; word_index < MAX_VID / 64; word_index++){
+        uint64_t word = set->bits[word_index];
+        while(word){
+            if(store_array != NULL){
+                store_array[counter] = (uint16_t)(word_index * 64 + __builtin_ctzll(word));
+            }
+            counter++;
+            word &= word - 1;
+        }
+    }
+    return counter;
+}
+
+
 // ============================================ function for unreachable ============================================ //
 struct unreachable_table* add_to_unreachable_table(struct unreachable_table* ut, char* new_VID_name){
     if(ut == NULL){
         ut = build_unreachable_table();
-        ut->VID_head = build_VID(new_VID_name);
-    }else{
-        ut->VID_head = add_to_VID_table(ut->VID_head,new_VID_name);
     }
+    vid_set_add(&ut->vids, new_VID_name);
     return ut;
 }
 
 
 struct unreachable_table* build_unreachable_table(){
-    struct unreachable_table* new_node = (struct unreachable_table*) malloc(sizeof(struct unreachable_table));
-    new_node->VID_head = NULL;
+    // calloc, not malloc + clear: vid_set_clear reads count, which would be
+    // uninitialized here (and a garbage nonzero count bumps topology_gen).
+    struct unreachable_table* new_node = (struct unreachable_table*) calloc(1, sizeof(struct unreachable_table));
     return new_node;
 }
 
 
-struct VID* find_unreachable_VID_by_name(struct unreachable_table* ut, char* VID_name){
-    return find_VID_by_name(ut->VID_head, VID_name);
+int find_unreachable_VID_by_name(struct unreachable_table* ut, char* VID_name){
+    return vid_set_contains(&ut->vids, VID_name);
 }
 
 
 struct unreachable_table* remove_unreachable_VID_by_name(struct unreachable_table* ut, char* VID_name){
-    ut->VID_head = remove_VID_by_name(ut->VID_head, VID_name);
+    vid_set_remove(&ut->vids, VID_name);
     return ut;
 }
 
 
 void print_unreachable_table(struct unreachable_table* ut){
-    print_VID_table(ut->VID_head);
+    print_vid_set(&ut->vids);
 }
 
 
@@ -318,33 +593,30 @@ void print_unreachable_table(struct unreachable_table* ut){
 struct reachable_table* add_to_reachable_table(struct reachable_table* rt, char* new_VID_name){
     if(rt == NULL){
         rt = build_reachable_table();
-        rt->VID_head = build_VID(new_VID_name);
-    }else{
-        rt->VID_head = add_to_VID_table(rt->VID_head,new_VID_name);
     }
+    vid_set_add(&rt->vids, new_VID_name);
     return rt;
 }
 
 struct reachable_table* build_reachable_table(){
-    struct reachable_table* new_node = (struct reachable_table*) malloc(sizeof(struct reachable_table));
-    new_node->VID_head = NULL;
+    struct reachable_table* new_node = (struct reachable_table*) calloc(1, sizeof(struct reachable_table));
     return new_node;
 }
 
 
-struct VID* find_reachable_VID_by_name(struct reachable_table* rt, char* VID_name){
-    return find_VID_by_name(rt->VID_head, VID_name);
+int find_reachable_VID_by_name(struct reachable_table* rt, char* VID_name){
+    return vid_set_contains(&rt->vids, VID_name);
 }
 
 
 struct reachable_table* remove_reachable_VID_by_name(struct reachable_table* rt, char* VID_name){
-    rt->VID_head = remove_VID_by_name(rt->VID_head, VID_name);
+    vid_set_remove(&rt->vids, VID_name);
     return rt;
 }
 
 
 void print_reachable_table(struct reachable_table* rt){
-    print_VID_table(rt->VID_head);
+    print_vid_set(&rt->vids);
 }
 
 
@@ -378,7 +650,23 @@ struct VID_offered_port* add_to_offered_table(struct VID_offered_port* vop_head,
     return vop_head;
 }
 
+/*
+    Same open-addressed name index the control port table uses. Offered ports
+    are only ever added (join handshakes), so nodes are indexed as they are
+    built and by-name lookups cost a hash plus a short probe instead of a
+    list walk per received message.
+*/
+static struct VID_offered_port* vop_index[CP_INDEX_SIZE];
+
 struct VID_offered_port* build_VID_offered_port(char* new_port_name){
+    // One node per port name; past MAX_PORTS the index probe loops could
+    // cycle forever, so fail fast like cp_index_build does.
+    static size_t vop_count = 0;
+    if(++vop_count > MAX_PORTS){
+        fprintf(stderr, "Too many offered ports (max %d), raise MAX_PORTS\n", MAX_PORTS);
+        exit(EXIT_FAILURE);
+    }
+    topology_gen++; // List growth changes every memoized topology answer.
     struct VID_offered_port* new_node = (struct VID_offered_port*)malloc(sizeof(struct VID_offered_port));
     strcpy(new_node->port_name, new_port_name);
     new_node->next = NULL;
@@ -386,16 +674,23 @@ struct VID_offered_port* build_VID_offered_port(char* new_port_name){
     new_node->cp = NULL;
     new_node->ut = build_unreachable_table();
     new_node->rt = build_reachable_table();
+
+    uint32_t slot = fnv1a_hash(new_node->port_name) & (CP_INDEX_SIZE - 1);
+    while(vop_index[slot]){
+        slot = (slot + 1) & (CP_INDEX_SIZE - 1);
+    }
+    vop_index[slot] = new_node;
+
     return new_node;
 }
 
 struct VID_offered_port* find_offered_port_by_name(struct VID_offered_port* vop_head, char *port_name){
-    struct VID_offered_port* vop_temp = vop_head;
-    while(vop_temp){
-        if(!strcmp(vop_temp->port_name, port_name)){
-            return vop_temp;
+    uint32_t slot = fnv1a_hash(port_name) & (CP_INDEX_SIZE - 1);
+    while(vop_index[slot]){
+        if(!strcmp(vop_index[slot]->port_name, port_name)){
+            return vop_index[slot];
         }
-        vop_temp = vop_temp->next;
+        slot = (slot + 1) & (CP_INDEX_SIZE - 1);
     }
     return NULL;
 }
@@ -411,12 +706,12 @@ size_t count_available_offered_port(struct VID_offered_port* vop_head, char** st
         // the eth port must be up, and the destination VID doesn't exist in the unreachable table of this port
         if(vop_temp->cp->isUP){
             int check = 0;
-            if(vop_temp->rt->VID_head != NULL){
+            if(vop_temp->rt->vids.count != 0){
                 if(find_reachable_VID_by_name(vop_temp->rt, dest_VID)) {
                     check = 1;
                 }
-            }else if(vop_temp->ut->VID_head != NULL){
-                if(find_unreachable_VID_by_name(vop_temp->ut, dest_VID) == NULL){
+            }else if(vop_temp->ut->vids.count != 0){
+                if(!find_unreachable_VID_by_name(vop_temp->ut, dest_VID)){
                     check = 1;
                 }
             }else{
@@ -435,50 +730,113 @@ size_t count_available_offered_port(struct VID_offered_port* vop_head, char** st
 }
 
 
+// Pointer-returning twin of count_available_offered_port: takes the VID as
+// the integer the data path already holds and stores each eligible port's
+// control_port directly, so the scan neither formats strings nor looks names
+// up again afterwards.
+size_t collect_available_offered_ports(struct VID_offered_port* vop_head, struct control_port** store_array, uint16_t dest_VID){
+    struct VID_offered_port* vop_temp = vop_head;
+    size_t counter = 0;
+    for(;vop_temp;vop_temp = vop_temp->next){
+        if(vop_temp->cp->isUP){
+            int check = 0;
+            if(vop_temp->rt->vids.count != 0){
+                if(vid_set_contains_value(&vop_temp->rt->vids, dest_VID)) {
+                    check = 1;
+                }
+            }else if(vop_temp->ut->vids.count != 0){
+                if(!vid_set_contains_value(&vop_temp->ut->vids, dest_VID)){
+                    check = 1;
+                }
+            }else{
+                check = 1;
+            }
+
+            if(check){
+                store_array[counter] = vop_temp->cp;
+                counter++;
+            }
+        }
+    }
+    return counter;
+}
+
+
 size_t get_offered_VIDs_by_port_name(struct VID_offered_port* vop_head, char* port_name, char **store_array){
     struct VID* VID_temp = find_offered_port_by_name(vop_head, port_name)->VID_head;
     return get_all_VIDs(VID_temp, store_array);
 }
 
 
-size_t get_reachable_VIDs_from_offered_ports(struct VID_offered_port* vop_head, char** store_array){
+size_t get_reachable_VIDs_from_offered_ports(struct VID_offered_port* vop_head, uint16_t* store_array){
     struct VID_offered_port* vop_temp = vop_head;
     size_t counter = 0;
     for(;vop_temp;vop_temp = vop_temp->next){
         if(vop_temp->cp->isUP && vop_temp->rt != NULL){
-            counter += get_all_VIDs(vop_temp->rt->VID_head, store_array + counter);
+            counter += vid_set_decode(&vop_temp->rt->vids, store_array + counter);
         }
     }
     return counter;
 }
 
 
-size_t get_unreachable_VIDs_from_offered_ports(struct VID_offered_port* vop_head, char** store_array){
+size_t get_unreachable_VIDs_from_offered_ports(struct VID_offered_port* vop_head, uint16_t* store_array){
     struct VID_offered_port* vop_temp = vop_head;
     size_t counter = 0;
     for(;vop_temp;vop_temp = vop_temp->next){
         if(vop_temp->cp->isUP && vop_temp->ut != NULL){
-            counter += get_all_VIDs(vop_temp->ut->VID_head, store_array + counter);
+            counter += vid_set_decode(&vop_temp->ut->vids, store_array + counter);
         }
     }
     return counter;
 }
 
 
+/*
+    The two predicates below only read state that cannot change without
+    topology_gen moving (port liveness, table populations, and list growth all
+    bump it), so each memoizes its last answer against the generation. The
+    failure/recover paths call them repeatedly per message; after the first
+    call each answer is a single compare until topology changes again.
+*/
 int is_unreachable_and_reachable_empty(struct VID_offered_port* vop_head){
+    static unsigned int memo_gen = 0;
+    static int memo_result;
+    if(memo_gen == topology_gen){
+        return memo_result;
+    }
+
+    int result = 0;
     struct VID_offered_port* vop_temp = vop_head;
     for(;vop_temp;vop_temp = vop_temp->next){
-        if(vop_temp->ut->VID_head == NULL && vop_temp->rt->VID_head == NULL) return 1;
+        if(vop_temp->ut->vids.count == 0 && vop_temp->rt->vids.count == 0){
+            result = 1;
+            break;
+        }
     }
-    return 0;
+    memo_gen = topology_gen;
+    memo_result = result;
+    return result;
 }
 
 int is_all_offered_ports_down(struct VID_offered_port* vop_head){
+    static unsigned int memo_gen = 0;
+    static int memo_result;
+    if(memo_gen == topology_gen){
+        return memo_result;
+    }
+
+    int result = 1;
     struct VID_offered_port* vop_temp = vop_head;
     for(;vop_temp;vop_temp = vop_temp->next){
-        if(vop_temp->cp->isUP) return 0;
+        if(vop_temp->cp->isUP){
+            result = 0;
+            break;
+        }
     }
-    return 1;
+    memo_gen = topology_gen;
+    memo_result = result;
+    return result;
 }
 
 
@@ -524,7 +882,16 @@ struct VID_accepted_port* add_to_accepted_table(struct VID_accepted_port* vap_he
 }
 
 
+// Accepted ports get the same name index as the offered table above.
+static struct VID_accepted_port* vap_index[CP_INDEX_SIZE];
+
 struct VID_accepted_port* build_VID_accepted_port(char* new_port_name){
+    static size_t vap_count = 0;
+    if(++vap_count > MAX_PORTS){
+        fprintf(stderr, "Too many accepted ports (max %d), raise MAX_PORTS\n", MAX_PORTS);
+        exit(EXIT_FAILURE);
+    }
+    topology_gen++; // List growth changes every memoized topology answer.
     struct VID_accepted_port* new_node = (struct VID_accepted_port*)malloc(sizeof(struct VID_accepted_port));
     strcpy(new_node->port_name, new_port_name);
     new_node->next = NULL;
@@ -532,17 +899,24 @@ struct VID_accepted_port* build_VID_accepted_port(char* new_port_name){
     new_node->cp = NULL;
     new_node->ut = build_unreachable_table();
     new_node->rt = build_reachable_table();
+
+    uint32_t slot = fnv1a_hash(new_node->port_name) & (CP_INDEX_SIZE - 1);
+    while(vap_index[slot]){
+        slot = (slot + 1) & (CP_INDEX_SIZE - 1);
+    }
+    vap_index[slot] = new_node;
+
     return new_node;
 }
 
 
 struct VID_accepted_port* find_accepted_port_by_name(struct VID_accepted_port* vap_head, char *port_name){
-    struct VID_accepted_port* vap_temp = vap_head;
-    while(vap_temp){
-        if(!strcmp(vap_temp->port_name, port_name)){
-            return vap_temp;
+    uint32_t slot = fnv1a_hash(port_name) & (CP_INDEX_SIZE - 1);
+    while(vap_index[slot]){
+        if(!strcmp(vap_index[slot]->port_name, port_name)){
+            return vap_index[slot];
         }
-        vap_temp = vap_temp->next;
+        slot = (slot + 1) & (CP_INDEX_SIZE - 1);
     }
     return NULL;
 }
@@ -574,16 +948,16 @@ struct VID_accepted_port* find_accepted_port_by_VID(struct VID_accepted_port* va
 
 
 
-size_t get_accepted_VIDs_by_port_name(struct VID_accepted_port* vap_head, char* port_name, char **store_array){
+size_t get_accepted_VIDs_by_port_name(struct VID_accepted_port* vap_head, char* port_name, uint16_t *store_array){
     struct VID* VID_temp = find_accepted_port_by_name(vap_head, port_name)->VID_head;
-    return get_all_VIDs(VID_temp, store_array);
+    return get_all_VID_values(VID_temp, store_array);
 }
 
-size_t get_all_accepted_VIDs(struct VID_accepted_port* vap_head, char **store_array){
+size_t get_all_accepted_VIDs(struct VID_accepted_port* vap_head, uint16_t *store_array){
     size_t counter = 0;
     for(struct VID_accepted_port* vap_temp = vap_head;vap_temp;vap_temp = vap_temp->next){
         if(vap_temp->cp->isUP){
-            counter += get_all_VIDs(vap_temp->VID_head, store_array + counter);
+            counter += get_all_VID_values(vap_temp->VID_head, store_array + counter);
         }
     }
     return counter;
@@ -16,30 +16,56 @@
 #include "mtp_utils.h" // Access MTP constants.
 
 /*****************************************
- * CONSTANTS 
+ * CONSTANTS
  *****************************************/
-// None
+#define ARENA_BLOCK_SIZE (256 * 1024) // Default arena block size, sized for the interface tables of a large node.
+
+#define CP_INDEX_SIZE 128 // Control port index slots; power of two, at most half full with MAX_PORTS ports.
+
+#define VID_POOL_SIZE (MAX_PORTS * 64) // VID list nodes preallocated for the offered/accepted/(un)reachable tables.
 
 /*****************************************
- * STRUCTURES 
+ * STRUCTURES
  *****************************************/
+/*
+    A bump allocator backing the per-port structures. Ports are discovered once
+    at start-up and live for the life of the process, so nodes are carved off a
+    single block (keeping them contiguous in traversal order) and are only ever
+    released en masse.
+*/
+typedef struct {
+    char *base;
+    char *cur;
+    char *end;
+} arena_t;
+
+/*
+    The keep-alive scan walks every node each loop pass but only reads the
+    liveness fields, so those sit together at the front of the node; with the
+    prebuilt TX frame held out of line (arena-backed, MAX_BUFFER_SIZE bytes)
+    the scan touches one cache line per port instead of dragging a 2 KiB
+    struct through the cache.
+*/
 struct control_port {
-    char port_name[ETH_LEN];  // Control Port Name
+    // Hot: read or written on every keep-alive scan.
     int isUP;                     // true [1] (if UP) or false [2] (if DOWN)
     int start;
     int fail_type;
+    int continue_count;
     long long last_received_time;
     long long last_sent_time;
-    int continue_count;
+    struct control_port *next;
+
+    // Cold: only needed when sending or on the fail path.
+    char port_name[ETH_LEN];  // Control Port Name
     struct notification* ntf_head;
-    uint8_t frame[MAX_BUFFER_SIZE];
+    uint8_t *frame; // Prebuilt Ethernet frame buffer.
     struct sockaddr_ll* socket_address;
-    struct control_port *next;
 };
 
 typedef struct compute_interface {
     char port_name[ETH_LEN];        // Interface name
-    uint8_t frame[MAX_BUFFER_SIZE]; // Starting frame
+    uint8_t *frame;                 // Starting frame (arena-backed, MAX_BUFFER_SIZE bytes)
     struct sockaddr_ll* socket_address;
     struct compute_interface *next;
 } compute_interface;
@@ -51,12 +77,27 @@ struct VID{
    struct VID *next;
 };
 
+/*
+    Dense bitmap backing the per-port reachable/unreachable sets. Everything
+    that flows into these sets is the integer prefix of a VID — copy_VID_prefix
+    strips the dotted tail before a VID ever goes on the wire — so membership,
+    insert, and remove collapse to single word operations and clearing a table
+    is a memset instead of a list teardown. Names that are not bare integers
+    (a port name, for instance) simply never match, as before.
+*/
+#define MAX_VID 1024
+
+typedef struct {
+    uint64_t bits[MAX_VID / 64];
+    uint16_t count; // Set-bit population, for O(1) emptiness checks.
+} vid_set;
+
 struct unreachable_table{
-    struct VID* VID_head;
+    vid_set vids;
 };
 
 struct reachable_table{
-    struct VID* VID_head;
+    vid_set vids;
 };
 
 //8_1_2022 when I offer VIDs to my upper tier spines, I store them in this linked list and refer using the port number
@@ -90,23 +131,35 @@ struct notification{
 };
 
 /*****************************************
- * FUNCTION PROTOTYPES 
+ * FUNCTION PROTOTYPES
  *****************************************/
+extern unsigned int topology_gen; // Incremented on any port-state or table change; see mtp_struct.c.
+
+
+// ====================== arena allocator ====================== //
+void arena_init(arena_t* arena, size_t size);
+void* arena_alloc(arena_t* arena, size_t size);
+void arena_free(arena_t* arena);
+
 // ====================== function for control_port ====================== //
-struct control_port* add_to_control_port_table(struct control_port* cp_head, char* new_port_name);
-struct control_port* build_control_port(char* new_port_name);
+struct control_port* add_to_control_port_table(arena_t* arena, struct control_port* cp_head, char* new_port_name);
+struct control_port* build_control_port(arena_t* arena, char* new_port_name);
 struct control_port* find_control_port_by_name(struct control_port* cp_head, char* port_name);
+void cp_index_build(struct control_port* cp_head);
+struct control_port* cp_lookup(const char* port_name);
+extern struct control_port* cp_array[MAX_PORTS]; // Flat traversal-order snapshot; see cp_index_build().
+extern size_t cp_array_len;
 struct control_port* remove_control_port_by_name(struct control_port* cp_head, char* port_name);
 struct control_port* clear_control_port(struct control_port* node);
-struct control_port* setControlInterfaces(struct ifaddrs *ifaddr, char *computeSubnetIntfName, bool isLeaf, const char* nodeName);
+void classifyInterfaces(struct ifaddrs *ifaddr, char *computeSubnetIntfName, bool isLeaf, const char* nodeName,
+                        compute_interface **compute_intf_head, struct control_port **cp_head);
 int is_all_down(struct control_port* cp_head);
 void print_control_port_table(struct control_port* cp_head);
 void initalizeControlSocketResources(int* socketfd, struct control_port* cp_head);
 
 // ====================== function for compute interfaces ====================== //
-compute_interface *addComputeInteface(compute_interface *ci_head, char *new_port_name);
-compute_interface *buildComputeInterface(char *new_port_name);
-compute_interface *setComputeInterfaces(struct ifaddrs *ifaddr, char *computeSubnetIntfName, bool isLeaf, const char* nodeName);
+compute_interface *addComputeInteface(arena_t *arena, compute_interface *ci_head, char *new_port_name);
+compute_interface *buildComputeInterface(arena_t *arena, char *new_port_name);
 compute_interface *freeComputeInterfaces(compute_interface *interface);
 void initalizeComputeSocketResources(int *socketfd, compute_interface *ci_head);
 void printComputeInterfaces(compute_interface *head);
@@ -118,26 +171,38 @@ struct VID* find_VID_by_name(struct VID* VID_head,char* VID_name);
 struct VID* remove_VID_by_name(struct VID* VID_head,char* VID_name);
 struct VID* clear_VID_table(struct VID* node);
 size_t get_all_VIDs(struct VID* VID_head, char** store_array);
+size_t get_all_VID_values(struct VID* VID_head, uint16_t* store_array);
 struct VID* convert_VID_array_to_VID_table( char** VID_array, uint16_t VID_array_size);
 struct VID* copy_VID_table(struct VID* VID_head);
 void copy_VID_prefix(char *dest, char* src);
 void print_VID_table(struct VID* VID_head);
 
 
+// ====================== function for vid_set ====================== //
+void vid_set_clear(vid_set* set);
+void vid_set_add_value(vid_set* set, uint16_t value);
+void vid_set_remove_value(vid_set* set, uint16_t value);
+int vid_set_add(vid_set* set, const char* VID_name);
+int vid_set_remove(vid_set* set, const char* VID_name);
+int vid_set_contains(const vid_set* set, const char* VID_name);
+int vid_set_contains_value(const vid_set* set, uint16_t value);
+size_t vid_set_decode(const vid_set* set, uint16_t* store_array);
+
+
 // ====================== function for unreachable ====================== //
 struct unreachable_table* add_to_unreachable_table(struct unreachable_table* ut, char* new_VID_name);
 struct unreachable_table* build_unreachable_table();
-struct VID* find_unreachable_VID_by_name(struct unreachable_table* ut, char* VID_name);
+int find_unreachable_VID_by_name(struct unreachable_table* ut, char* VID_name);
 struct unreachable_table* remove_unreachable_VID_by_name(struct unreachable_table* ut, char* VID_name);
-void print_unreachable_table(struct unreachable_table* ut);
+void print_unreachable_table(struct unreachable_table* ut) __attribute__((cold));
 
 
 // ====================== function for reachable ====================== //
 struct reachable_table* add_to_reachable_table(struct reachable_table* rt, char* new_VID_name);
 struct reachable_table* build_reachable_table();
-struct VID* find_reachable_VID_by_name(struct reachable_table* rt, char* VID_name);
+int find_reachable_VID_by_name(struct reachable_table* rt, char* VID_name);
 struct reachable_table* remove_reachable_VID_by_name(struct reachable_table* rt, char* VID_name);
-void print_reachable_table(struct reachable_table* ut);
+void print_reachable_table(struct reachable_table* ut) __attribute__((cold));
 
 
 // ====================== function for VID_offered_table ====================== //
@@ -147,9 +212,10 @@ struct VID_offered_port* find_offered_port_by_name(struct VID_offered_port* vop_
 struct VID_offered_port* find_offered_port_by_VID(struct VID_offered_port* vop_head, char *VID_name);
 
 size_t count_available_offered_port(struct VID_offered_port* vop_head, char** store_array, char* dest_VID);
+size_t collect_available_offered_ports(struct VID_offered_port* vop_head, struct control_port** store_array, uint16_t dest_VID);
 size_t get_offered_VIDs_by_port_name(struct VID_offered_port* vop_head, char* port_name, char **store_array);
-size_t get_reachable_VIDs_from_offered_ports(struct VID_offered_port* vop_head, char** store_array);
-size_t get_unreachable_VIDs_from_offered_ports(struct VID_offered_port* vop_head, char** store_array);
+size_t get_reachable_VIDs_from_offered_ports(struct VID_offered_port* vop_head, uint16_t* store_array);
+size_t get_unreachable_VIDs_from_offered_ports(struct VID_offered_port* vop_head, uint16_t* store_array);
 int is_unreachable_and_reachable_empty(struct VID_offered_port* vop_head);
 int is_all_offered_ports_down(struct VID_offered_port* vop_head);
 
@@ -162,8 +228,8 @@ struct VID_accepted_port* build_VID_accepted_port(char* new_port_name);
 struct VID_accepted_port* find_accepted_port_by_name(struct VID_accepted_port* vap_head, char *port_name);
 struct VID_accepted_port* find_accepted_port_by_VID(struct VID_accepted_port* vap_head, char *VID_name);
 
-size_t get_accepted_VIDs_by_port_name(struct VID_accepted_port* vap_head, char* port_name, char **store_array);
-size_t get_all_accepted_VIDs(struct VID_accepted_port* vap_head, char **store_array);
+size_t get_accepted_VIDs_by_port_name(struct VID_accepted_port* vap_head, char* port_name, uint16_t *store_array);
+size_t get_all_accepted_VIDs(struct VID_accepted_port* vap_head, uint16_t *store_array);
 
 void print_accepted_table(struct VID_accepted_port* vap_head);
 
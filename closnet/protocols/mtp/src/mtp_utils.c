@@ -3,11 +3,12 @@
 #include "mtp_struct.h"
 #include "logger.h"
 
-// it is different from previous one, it stores the port data to a 2d array
-uint8_t get_all_ethernet_interface2(char** dest, const char* nodeName)
+// it is different from previous one, it stores the port data to a contiguous name set
+uint8_t get_all_ethernet_interface2(intf_name_set* dest, const char* nodeName)
 {
-    uint8_t counter = 0;
-    struct ifaddrs *addrs, *tmp;                                        
+    struct ifaddrs *addrs, *tmp;
+
+    dest->count = 0;
 
     if(getifaddrs(&addrs) == -1) 
     {
@@ -17,16 +18,23 @@ uint8_t get_all_ethernet_interface2(char** dest, const char* nodeName)
 
     tmp = addrs; // initialize tmp to where addresses are stored
 
+    /* The node name is fixed, so compute its length once instead of per interface;
+    *  the compiler cannot hoist the strlen itself because nodeName may alias. */
+    const size_t nodeNameLen = strlen(nodeName);
+
     /* Walk the interface list and copy those that are both
     *  - administratively UP          (IFF_UP)
     *  - carrier present / lower-layer up (IFF_LOWER_UP or, as a fallback, IFF_RUNNING)
     */
-    while (tmp) 
+    while (tmp)
     {
+        /* Pull the next pointer-chased node in while this one is examined. */
+        if (tmp->ifa_next) __builtin_prefetch(tmp->ifa_next, 0, 0);
+
         if (tmp->ifa_addr && tmp->ifa_addr->sa_family == AF_PACKET) {
 
             /* Does this ifname start with the node’s prefix? */
-            if (strncmp(tmp->ifa_name, nodeName, strlen(nodeName)) == 0) {
+            if (strncmp(tmp->ifa_name, nodeName, nodeNameLen) == 0) {
 
                 /* Admin-up? */
                 if (tmp->ifa_flags & IFF_UP) {
@@ -39,8 +47,11 @@ uint8_t get_all_ethernet_interface2(char** dest, const char* nodeName)
     #endif
                     {
                         /* Interface is usable – keep it */
-                        strcpy(dest[counter], tmp->ifa_name);
-                        counter++;
+                        if (dest->count < MAX_PORTS) {
+                            strncpy(dest->names[dest->count], tmp->ifa_name, IFNAMSIZ - 1);
+                            dest->names[dest->count][IFNAMSIZ - 1] = '\0';
+                            dest->count++;
+                        }
                     }
                 }
             }
@@ -51,15 +62,15 @@ uint8_t get_all_ethernet_interface2(char** dest, const char* nodeName)
 
     freeifaddrs(addrs);
 
-    return counter; // return the size of all working ports
+    return dest->count; // return the size of all working ports
 }
 
 
-int check_port_is_alive(char** port_array, uint8_t port_array_size, char* port_name)
+int check_port_is_alive(const intf_name_set* port_set, char* port_name)
 {
-    for(uint8_t i = 0; i < port_array_size; i++)
+    for(uint8_t i = 0; i < port_set->count; i++)
     {
-        if(!strcmp(port_array[i],port_name))
+        if(!strcmp(port_set->names[i], port_name))
         { // if found, return true
             return 1;
         }
@@ -137,7 +148,12 @@ uint16_t extract_VID_from_receive_buff(char **VID_array, char *recvBuff_start_pt
     for(int i = 0;i < numOfVID;i++){
         uint8_t vid_len = recvBuff_start_ptr[p];
         p++;
-        strncpy(VID_array[i],recvBuff_start_ptr + p,vid_len);
+        /*
+            The VID length is carried in the payload, so the copy needs no NUL
+            hunt or zero-fill; memcpy moves the slice in wide loads instead of
+            strncpy's byte-at-a-time walk.
+        */
+        memcpy(VID_array[i],recvBuff_start_ptr + p,vid_len);
         VID_array[i][vid_len] = '\0';
         p += vid_len;
     }
@@ -145,6 +161,40 @@ uint16_t extract_VID_from_receive_buff(char **VID_array, char *recvBuff_start_pt
 }
 
 
+/*
+    Update-path variant of the extractor: the failure/recover handlers feed
+    every VID straight into a per-port bitmap, so the numeric prefix is
+    decoded here, in the same pass that copies the slice, instead of being
+    re-parsed from the string for every table it touches. A VID with no
+    leading digits (or one past the bitmap range) reports UINT16_MAX, which
+    no bitmap operation accepts.
+*/
+uint16_t extract_VID_values_from_receive_buff(char **VID_array, uint16_t *value_array, char *recvBuff_start_ptr){
+    uint16_t numOfVID = 0;
+    memcpy(&numOfVID,recvBuff_start_ptr,2);
+    int p = 2;
+    for(int i = 0;i < numOfVID;i++){
+        uint8_t vid_len = recvBuff_start_ptr[p];
+        p++;
+        if(VID_array != NULL){ // The update handlers work from values alone.
+            memcpy(VID_array[i],recvBuff_start_ptr + p,vid_len);
+            VID_array[i][vid_len] = '\0';
+        }
+
+        uint32_t value = 0;
+        uint8_t digits = 0;
+        while(digits < vid_len && recvBuff_start_ptr[p + digits] >= '0' && recvBuff_start_ptr[p + digits] <= '9'){
+            value = value * 10 + (uint32_t)(recvBuff_start_ptr[p + digits] - '0');
+            digits++;
+        }
+        value_array[i] = (digits == 0 || value >= UINT16_MAX) ? UINT16_MAX : (uint16_t)value;
+
+        p += vid_len;
+    }
+    return numOfVID;
+}
+
+
 // hash algorithm for loading balancing
 uint32_t jenkins_one_at_a_time_hash(uint8_t *key, size_t len){
     uint32_t hash, i;
@@ -160,6 +210,33 @@ uint32_t jenkins_one_at_a_time_hash(uint8_t *key, size_t len){
     return hash;
 }
 
+/*
+    4-byte flow hash used for ECMP port selection. Only the distribution of
+    the hash matters to the callers, so on x86 parts with SSE4.2 the whole
+    byte-serial Jenkins loop collapses into a single crc32 instruction; the
+    CPU probe result is latched on first use and everything else falls back
+    to Jenkins over the same four bytes.
+*/
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_flow_hash(uint32_t flow_key){
+    return __builtin_ia32_crc32si(0, flow_key);
+}
+#endif
+
+uint32_t flow_hash_u32(uint32_t flow_key){
+#if defined(__x86_64__) || defined(__i386__)
+    static int have_crc32 = -1;
+    if(__builtin_expect(have_crc32 < 0, 0)){
+        have_crc32 = __builtin_cpu_supports("sse4.2");
+    }
+    if(have_crc32){
+        return crc32c_flow_hash(flow_key);
+    }
+#endif
+    return jenkins_one_at_a_time_hash((uint8_t*)&flow_key, sizeof(flow_key));
+}
+
 // convert integer to string (char[])
 size_t int_to_str(char *dest_storage, unsigned int number)
 {
@@ -191,10 +268,24 @@ size_t int_to_str(char *dest_storage, unsigned int number)
 
 
 // get current time in millisecond
-long long get_milli_sec(struct timeval* current_time){
-    gettimeofday(current_time, NULL);
-    long long milliseconds = current_time->tv_sec*1000LL + current_time->tv_usec/1000;
-    return milliseconds;
+// CLOCK_REALTIME_COARSE is a plain vDSO read of the last tick, which is far
+// Tick-granularity epoch time for the hello/dead timer bookkeeping, where the
+// coarse clock's resolution (a few ms at worst) is well under the timers it
+// feeds. Not for logged measurements — see get_milli_sec_precise().
+long long get_milli_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return ts.tv_sec*1000LL + ts.tv_nsec/1000000;
+}
+
+// Full-resolution epoch time for the timestamps the analysis scripts subtract
+// to measure detection and reconvergence latency, which can itself be a few
+// milliseconds. CLOCK_REALTIME goes through the vDSO, so this is still
+// syscall-free; only the hot timer comparisons use the coarse clock above.
+long long get_milli_sec_precise(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec*1000LL + ts.tv_nsec/1000000;
 }
 
 // initialize socket resource for each port
@@ -209,7 +300,10 @@ void initalizeControlSocketResources(int* socketfd, struct control_port* cp_head
 	    struct ifreq if_mac;
         char ifName[IFNAMSIZ];
         strcpy(ifName, cp_temp->port_name);
-        struct ether_header *eh = (struct ether_header*)calloc(1, sizeof(struct ether_header));
+
+        // Compose the Ethernet II header in place in the port's cached frame;
+        // every later send reuses it, only the payload behind it changes.
+        struct ether_header *eh = (struct ether_header*)cp_temp->frame;
         struct sockaddr_ll* socket_address = (struct sockaddr_ll*) calloc(1,sizeof(struct sockaddr_ll));
         memset(&if_idx, 0, sizeof(struct ifreq));
 	    strncpy(if_idx.ifr_name, ifName, IFNAMSIZ - 1);
@@ -232,8 +326,6 @@ void initalizeControlSocketResources(int* socketfd, struct control_port* cp_head
         // Ethertype set to 0x8850, which is the custom MTP type.
         eh->ether_type = htons(ETH_MTP_CTRL);
 
-        memcpy(cp_temp->frame, eh, sizeof(struct ether_header));
-
         socket_address->sll_ifindex = if_idx.ifr_ifindex;
 
         socket_address->sll_halen = ETH_ALEN;
@@ -244,7 +336,6 @@ void initalizeControlSocketResources(int* socketfd, struct control_port* cp_head
 
         cp_temp->socket_address = socket_address;
 
-        free(eh);
         cp_temp = cp_temp->next;
     }
 }
@@ -264,8 +355,9 @@ void initalizeComputeSocketResources(int *socketfd, compute_interface *ci_head)
         char ifName[IFNAMSIZ];
         strcpy(ifName, ci_temp->port_name);
         
-        // Structures defining the Ethernet II header
-        struct ether_header *eh = (struct ether_header*)calloc(1, sizeof(struct ether_header));
+        // Compose the Ethernet II header directly in the interface's cached
+        // frame so outgoing traffic already has it set.
+        struct ether_header *eh = (struct ether_header*)ci_temp->frame;
         struct sockaddr_ll* socket_address = (struct sockaddr_ll*) calloc(1,sizeof(struct sockaddr_ll));
         
         memset(&if_idx, 0, sizeof(struct ifreq));
@@ -297,9 +389,6 @@ void initalizeComputeSocketResources(int *socketfd, compute_interface *ci_head)
         // Ethertype set to 0x0800, which is the IPv4 type.
         eh->ether_type = htons(ETH_IP_CTRL);
 
-        // Copy the Ethernet II header to the interface structure so that traffic being sent from this interface already has it set.
-        memcpy(ci_temp->frame, eh, sizeof(struct ether_header));
-
         socket_address->sll_ifindex = if_idx.ifr_ifindex;
         socket_address->sll_halen = ETH_ALEN;
 
@@ -311,9 +400,6 @@ void initalizeComputeSocketResources(int *socketfd, compute_interface *ci_head)
         // Copy the starting socket address for the same reason as the Ethernet II header.
         ci_temp->socket_address = socket_address;
 
-        // Free Ethernet header memory
-        free(eh);
-
         ci_temp = ci_temp->next;
     }
 }
\ No newline at end of file
@@ -51,6 +51,13 @@
 #define HELLO_TIMER 100 // prior 10 in GENI.
 #define DEAD_TIMER 250 // prior 25 in GENI.
 
+/*
+    Upper bound on how long the main loop sleeps in poll() when no traffic is
+    pending. Keeps keep-alive ticks and failure detection an order of magnitude
+    finer than HELLO_TIMER/DEAD_TIMER while letting an idle switch yield the CPU.
+*/
+#define POLL_TIMEOUT_MS 10
+
 #define DETECT_FAIL 1
 #define MISS_FAIL 2
 
@@ -63,21 +70,46 @@
 #define ADD_OPERATION 1
 #define REMOVE_OPERATION 0
 
+#define MAX_PORTS 64 // Upper bound on the interfaces a single node can have.
+
+#define MAX_IFINDEX 256 // Upper bound on kernel interface indices cached for RX lookups.
+
+#define RECV_BURST 32 // Frames drained per recvmmsg() call in the main loop.
+
+/*
+    TPACKET_V3 RX ring geometry for the MTP socket. The kernel writes frames
+    straight into the mmap'd ring, so RX costs no per-packet syscall or copy.
+    Blocks retire to userspace after 1 ms at the latest, keeping control
+    message latency well under the protocol timers.
+*/
+#define RX_RING_BLOCK_SIZE (1 << 15)
+#define RX_RING_BLOCK_NR 64
+#define RX_RING_FRAME_SIZE 2048
+#define RX_RING_RETIRE_MS 1
+
 /*****************************************
- * STRUCTURES 
+ * STRUCTURES
  *****************************************/
-// None
+/*
+    Fixed-capacity set of interface names stored in one contiguous block.
+    IFNAMSIZ is 16, so four names share a cache line; scanning the set is a
+    sequential walk instead of chasing per-name heap pointers.
+*/
+typedef struct {
+    char names[MAX_PORTS][IFNAMSIZ];
+    uint8_t count;
+} intf_name_set;
 
 /*****************************************
  * FUNCTION PROTOTYPES 
  *****************************************/
 /**
  * @brief Get the all ethernet interface2 object
- * 
- * @param dest destination array to store ethernet interface name
+ *
+ * @param dest destination name set to store ethernet interface names
  * @return uint8_t total working ethernet interface
  */
-uint8_t get_all_ethernet_interface2(char** dest, const char* nodeName);
+uint8_t get_all_ethernet_interface2(intf_name_set* dest, const char* nodeName);
 
 /**
  * @brief Get the VID by ethernet interface object
@@ -90,13 +122,12 @@ void getRootVID(char *dest, char *ethernet_interface_name, uint8_t octet);
 
 /**
  * @brief check whether the provided ethernet interface name is alive
- * 
- * @param port_array ethernet interface list
- * @param port_array_size ethernet interface size
+ *
+ * @param port_set working ethernet interface name set
  * @param port_name provided interface name
  * @return int 0 for false, 1 for true
  */
-int check_port_is_alive(char** port_array, uint8_t port_array_size,char* port_name);
+int check_port_is_alive(const intf_name_set* port_set, char* port_name);
 
 /**
  * @brief Get the tier from hello message payload
@@ -123,6 +154,7 @@ void append_port_number_after_VID(char *port_name, char *dest);
  * @return uint16_t 
  */
 uint16_t extract_VID_from_receive_buff(char **VID_array, char *recvBuff_start_ptr,int with_debug);
+uint16_t extract_VID_values_from_receive_buff(char **VID_array, uint16_t *value_array, char *recvBuff_start_ptr);
 
 /**
  * @brief hashing algorithm for load balancing, for more https://en.wikipedia.org/wiki/Jenkins_hash_function
@@ -133,6 +165,15 @@ uint16_t extract_VID_from_receive_buff(char **VID_array, char *recvBuff_start_pt
  */
 uint32_t jenkins_one_at_a_time_hash(uint8_t *key, size_t len);
 
+/**
+ * @brief hash a 4-byte flow key for ECMP port selection; uses the crc32
+ *        instruction when the CPU has SSE4.2, Jenkins otherwise
+ *
+ * @param flow_key the four address bytes identifying the flow
+ * @return uint32_t a hashcode
+ */
+uint32_t flow_hash_u32(uint32_t flow_key);
+
 /**
  * @brief convert integer to string
  * 
@@ -144,10 +185,10 @@ size_t int_to_str(char *dest_storage, unsigned int number);
 
 /**
  * @brief Get current time in milli second
- * 
- * @param current_time 
+ *
  * @return long long milli second
  */
-long long get_milli_sec(struct timeval* current_time);
+long long get_milli_sec(void);
+long long get_milli_sec_precise(void);
 
 #endif
\ No newline at end of file
@@ -11,8 +11,9 @@
 #include <errno.h>
 
 
-// Function to extract and print the number after "eth" in the interface name
-void print_port_number(const char *ifa_name) 
+// Function to extract and format the number after "eth" in the interface name.
+// Appends to the caller's line buffer; returns the number of bytes written.
+int format_port_number(char *buf, size_t buf_len, const char *ifa_name)
 {
     // Find the "eth" substring in ifa_name
     const char *eth_position = strstr(ifa_name, "eth");
@@ -22,9 +23,11 @@ void print_port_number(const char *ifa_name)
         // Move past the "eth" substring
         eth_position += 3;
 
-        // Print the number following "eth"
-        printf("\tPort number: %s\n", eth_position);
+        // Format the number following "eth"
+        return snprintf(buf, buf_len, "\tPort number: %s\n", eth_position);
     }
+
+    return 0;
 }
 
 // Mininet interfaces always start with the node name (ex: sw121-eth1), so we can use this to filter out the host interfaces.
@@ -34,6 +37,10 @@ void print_interfaces(const char* switch_name)
     int family, s;
     char host[NI_MAXHOST];
 
+    // The switch name is fixed for the whole walk, so measure it once here
+    // rather than once per interface.
+    size_t switch_name_len = strlen(switch_name);
+
     if (getifaddrs(&ifaddr) == -1) {
         perror("getifaddrs");
         exit(EXIT_FAILURE);
@@ -48,12 +55,18 @@ void print_interfaces(const char* switch_name)
         family = ifa->ifa_addr->sa_family;
 
         // CHECK IF THE INTERFACE NAME STARTS WITH THE SWITCH NAME.
-        if (strncmp(ifa->ifa_name, switch_name, strlen(switch_name)) == 0) {
-            // Print interface name
-            printf("Interface: %s\n", ifa->ifa_name);
-
-            // Print the port number (substring after the dash)
-            print_port_number(ifa->ifa_name);
+        // memcmp over the fixed-length prefix; interface names live in
+        // IFNAMSIZ-sized buffers and a Mininet node name is always shorter
+        // than that, so the comparison stays in bounds either way.
+        if (memcmp(ifa->ifa_name, switch_name, switch_name_len) == 0) {
+            // Build the whole entry in one buffer so it reaches the terminal
+            // as a single write instead of one per line. Sized so a maximal
+            // getnameinfo host plus both headers can never truncate.
+            char entry[NI_MAXHOST + 128];
+            int len = snprintf(entry, sizeof(entry), "Interface: %s\n", ifa->ifa_name);
+
+            // Format the port number (substring after the dash)
+            len += format_port_number(entry + len, sizeof(entry) - len, ifa->ifa_name);
 
             // For an AF_INET* interface address, display the address
             if (family == AF_INET || family == AF_INET6) {
@@ -63,11 +76,13 @@ void print_interfaces(const char* switch_name)
                                 host, NI_MAXHOST,
                                 NULL, 0, NI_NUMERICHOST);
                 if (s != 0) {
-                    printf("getnameinfo() failed: %s\n", gai_strerror(s));
+                    len += snprintf(entry + len, sizeof(entry) - len, "getnameinfo() failed: %s\n", gai_strerror(s));
                 } else {
-                    printf("\tAddress: <%s>\n", host);
+                    len += snprintf(entry + len, sizeof(entry) - len, "\tAddress: <%s>\n", host);
                 }
             }
+
+            fwrite(entry, 1, len, stdout);
         }
     }
 
@@ -5,7 +5,8 @@ MTP_SRC_DIR="closnet/protocols/mtp/src"
 MTP_BIN="closnet/protocols/mtp/bin/mtp"
 
 if [ -d "$MTP_SRC_DIR" ]; then
-    sudo gcc $MTP_SRC_DIR/*.c -o $MTP_BIN
+    # -pthread for the background log drain thread.
+    sudo gcc -pthread $MTP_SRC_DIR/*.c -o $MTP_BIN
     echo "MTP implementation compilation attempt complete."
 else
     echo "MTP implementation source directory not found, skipping compilation."